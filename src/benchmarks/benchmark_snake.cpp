@@ -0,0 +1,147 @@
+#include <benchmark/benchmark.h>
+
+#include <type_traits>
+
+#include "../brick_game/common.h"
+#include "../brick_game/snake/apple.h"
+#include "../brick_game/snake/autopilot.h"
+#include "../brick_game/snake/field.h"
+#include "../brick_game/snake/snake.h"
+#include "../brick_game/snake/snake_game.h"
+#include "../brick_game/snake/states/game_over_state.h"
+#include "../brick_game/snake/states/idle_state.h"
+#include "../brick_game/snake/states/paused_state.h"
+#include "../brick_game/snake/states/playing_state.h"
+
+using namespace s21;
+
+namespace {
+
+// Змейка длины 4 бесконечно ходит по квадрату 2x2, каждый раз занимая
+// клетку, которую освобождает хвост
+constexpr Snake::Direction LOOP[] = {
+    Snake::Direction::UP, Snake::Direction::LEFT, Snake::Direction::DOWN,
+    Snake::Direction::RIGHT};
+
+template <typename T>
+T makeState() {
+  if constexpr (std::is_same_v<T, GameOverState>) {
+    return GameOverState(false);
+  } else {
+    return T();
+  }
+}
+
+}  // namespace
+
+static void BM_SnakeMove(benchmark::State& state) {
+  Snake snake;
+  snake.initialize(Point(5, 5));
+  int step = 0;
+  for (auto _ : state) {
+    snake.setDirection(LOOP[step++ & 3]);
+    benchmark::DoNotOptimize(snake.move(false));
+  }
+}
+BENCHMARK(BM_SnakeMove);
+
+// Аргумент - число занятых клеток поля
+static void BM_AppleSpawn(benchmark::State& state) {
+  Field field;
+  Snake snake;
+  Apple apple;
+  for (int i = 0; i < state.range(0); ++i) {
+    field.setCell(i % Field::WIDTH, i / Field::WIDTH, Field::SNAKE);
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(apple.spawn(field, snake));
+  }
+}
+BENCHMARK(BM_AppleSpawn)->Arg(4)->Arg(100)->Arg(196);
+
+static void BM_PlayingStateUpdate(benchmark::State& state) {
+  SnakeGame game;
+  game.start();
+  game.getApple().setPosition(Point(0, 0));
+  PlayingState playing;
+  Snake& snake = game.getSnake();
+  Point head = snake.getHead();
+  int step = 0;
+  for (auto _ : state) {
+    snake.setDirection(LOOP[step & 3]);
+    playing.update(game);
+    if (snake.getHead() != head) {
+      head = snake.getHead();
+      ++step;
+    }
+  }
+}
+BENCHMARK(BM_PlayingStateUpdate);
+
+// Поле не меняется между кадрами: снимок берется из кэша
+template <typename T>
+static void BM_GetGameInfoCached(benchmark::State& state) {
+  SnakeGame game;
+  game.start();
+  T game_state = makeState<T>();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(game_state.getGameInfo(game));
+  }
+}
+BENCHMARK_TEMPLATE(BM_GetGameInfoCached, IdleState);
+BENCHMARK_TEMPLATE(BM_GetGameInfoCached, PlayingState);
+BENCHMARK_TEMPLATE(BM_GetGameInfoCached, PausedState);
+BENCHMARK_TEMPLATE(BM_GetGameInfoCached, GameOverState);
+
+// Поле меняется перед каждым кадром: снимок пересобирается
+template <typename T>
+static void BM_GetGameInfoChanged(benchmark::State& state) {
+  SnakeGame game;
+  game.start();
+  T game_state = makeState<T>();
+  bool wall = false;
+  for (auto _ : state) {
+    wall = !wall;
+    game.getField().setCell(0, 0, wall ? Field::WALL : Field::EMPTY);
+    benchmark::DoNotOptimize(game_state.getGameInfo(game));
+  }
+}
+BENCHMARK_TEMPLATE(BM_GetGameInfoChanged, IdleState);
+BENCHMARK_TEMPLATE(BM_GetGameInfoChanged, PlayingState);
+BENCHMARK_TEMPLATE(BM_GetGameInfoChanged, PausedState);
+BENCHMARK_TEMPLATE(BM_GetGameInfoChanged, GameOverState);
+
+// Кадр фронтенда через C-интерфейс. Start перезапускает игру после
+// проигрыша и игнорируется во время игры.
+static void BM_SnakeUpdateCurrentState(benchmark::State& state) {
+  for (auto _ : state) {
+    userInput(Start, false);
+    benchmark::DoNotOptimize(updateCurrentState());
+  }
+}
+BENCHMARK(BM_SnakeUpdateCurrentState);
+
+// Решение автопилота на поле со змейкой средней длины
+static void BM_AutopilotDecide(benchmark::State& state) {
+  SnakeGame game;
+  Autopilot pilot;
+  pilot.playGame(game, 400);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(pilot.decide(game));
+  }
+}
+BENCHMARK(BM_AutopilotDecide);
+
+// Партии автопилота без фронтенда; items/s - ходы в секунду
+static void BM_AutopilotGame(benchmark::State& state) {
+  SnakeGame game;
+  Autopilot pilot;
+  int64_t moves = 0;
+  for (auto _ : state) {
+    moves += pilot.playGame(game, static_cast<int>(state.range(0)));
+  }
+  state.SetItemsProcessed(moves);
+}
+BENCHMARK(BM_AutopilotGame)->Arg(1000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,143 @@
+#include <benchmark/benchmark.h>
+
+#include "../brick_game/tetris/tetris_lib.h"
+#include "../brick_game/tetris/tetris_placement.h"
+
+namespace {
+
+// Типичная позиция середины партии: неровная куча высотой около 8 строк,
+// в которой заполнено lines нижних строк
+Game_intro makeBoard(int lines) {
+  Game_intro val{};
+  for (int y = 0; y < FIELD_HEIGHT; ++y) {
+    val.field[y] = WALL_MASK;
+  }
+  for (int y = 12; y < FIELD_HEIGHT; ++y) {
+    for (int x = 0; x < FIELD_WIDTH; ++x) {
+      if ((x * 7 + y * 3) % 5 != 0) {
+        val.field[y] |= static_cast<uint16_t>(1u << (x + ROW_SHIFT));
+      }
+    }
+  }
+  for (int y = FIELD_HEIGHT - lines; y < FIELD_HEIGHT; ++y) {
+    val.field[y] = FULL_ROW;
+  }
+  init_figure(&val, 4);
+  val.fig = val.next_fig;
+  val.fig.y = 8;
+  return val;
+}
+
+}  // namespace
+
+static void BM_DelFullLine(benchmark::State& state) {
+  const Game_intro board = makeBoard(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    Game_intro val = board;
+    benchmark::DoNotOptimize(del_full_line(&val));
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_DelFullLine)->Arg(0)->Arg(1)->Arg(4);
+
+static void BM_Check(benchmark::State& state) {
+  Game_intro val = makeBoard(0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(check(&val));
+    benchmark::DoNotOptimize(check_left(&val));
+    benchmark::DoNotOptimize(check_right(&val));
+    benchmark::DoNotOptimize(check_y(&val));
+  }
+}
+BENCHMARK(BM_Check);
+
+static void BM_CheckRotate(benchmark::State& state) {
+  Game_intro val = makeBoard(0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(check_rotate(&val));
+  }
+}
+BENCHMARK(BM_CheckRotate);
+
+static void BM_DropRow(benchmark::State& state) {
+  Game_intro val = makeBoard(0);
+  val.fig.y = -2;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(drop_row(val.field, &val.fig));
+  }
+}
+BENCHMARK(BM_DropRow);
+
+static void BM_FindPlacements(benchmark::State& state) {
+  Game_intro val = makeBoard(0);
+  val.fig.y = -2;
+  Placement_t out[MAX_PLACEMENTS];
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(find_placements(&val, out, MAX_PLACEMENTS));
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_FindPlacements);
+
+// Шаг партии с виртуальными часами; после проигрыша партия перезапускается
+static void BM_TetrisStep(benchmark::State& state) {
+  static const UserAction_t ACTIONS[] = {Left, Action, Right, Down, Up};
+  TetrisGame* game = tetris_create();
+  tetris_set_clock(game, Clock_virtual, 50);
+  unsigned i = 0;
+  for (auto _ : state) {
+    UserAction_t action = ACTIONS[i++ % 5];
+    if (tetris_state(game)->status == Game_over) action = Start;
+    tetris_step(game, action);
+  }
+  tetris_destroy(game);
+}
+BENCHMARK(BM_TetrisStep);
+
+static void BM_TetrisQuery(benchmark::State& state) {
+  TetrisGame* game = tetris_create();
+  tetris_set_clock(game, Clock_virtual, 50);
+  tetris_step(game, Start);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(tetris_query(game));
+  }
+  tetris_destroy(game);
+}
+BENCHMARK(BM_TetrisQuery);
+
+// Снимок и восстановление состояния середины партии (копия для поиска)
+static void BM_TetrisSnapshot(benchmark::State& state) {
+  Game_intro val = makeBoard(0);
+  Game_intro copy{};
+  TetrisSnapshot_t snap;
+  for (auto _ : state) {
+    tetris_pack(&val, &snap);
+    benchmark::DoNotOptimize(tetris_unpack(&snap, &copy));
+  }
+}
+BENCHMARK(BM_TetrisSnapshot);
+
+static void BM_TetrisFork(benchmark::State& state) {
+  TetrisGame* game = tetris_create();
+  tetris_set_clock(game, Clock_virtual, 50);
+  tetris_step(game, Start);
+  for (auto _ : state) {
+    TetrisGame* fork = tetris_fork(game);
+    benchmark::DoNotOptimize(fork);
+    tetris_destroy(fork);
+  }
+  tetris_destroy(game);
+}
+BENCHMARK(BM_TetrisFork);
+
+// Кадр фронтенда через C-интерфейс (партия по умолчанию, реальные часы).
+// Start перезапускает партию после проигрыша и игнорируется во время игры.
+static void BM_TetrisUpdateCurrentState(benchmark::State& state) {
+  for (auto _ : state) {
+    userInput(Start, false);
+    benchmark::DoNotOptimize(updateCurrentState());
+  }
+}
+BENCHMARK(BM_TetrisUpdateCurrentState);
+
+BENCHMARK_MAIN();
@@ -17,6 +17,9 @@ typedef enum {
   Action
 } UserAction_t;
 
+/// Значение клетки field для тени фигуры (место, куда она упадет)
+#define CELL_GHOST (-1)
+
 typedef struct {
   int **field;
   int **next;
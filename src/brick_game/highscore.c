@@ -0,0 +1,258 @@
+#include "highscore.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief Кэшированный рекорд одного файла.
+ */
+typedef struct {
+  char path[HIGHSCORE_PATH_MAX];
+  int score;  ///< Известный рекорд
+  int dirty;  ///< Рекорд еще не записан в файл
+} HighScoreFile_t;
+
+/**
+ * @brief Законченная партия, ждущая записи в таблицу лучших.
+ */
+typedef struct {
+  int game;
+  LeaderboardEntry_t entry;
+} HighScoreRun_t;
+
+/**
+ * Порядок захвата: сначала io, потом lock. Запись файлов идет под io без
+ * lock, поэтому игра может обновлять кэш, пока поток пишет на диск.
+ */
+static struct {
+  pthread_mutex_t lock;  ///< Кэш и флаги потока
+  pthread_mutex_t io;    ///< Идущая запись файлов
+  pthread_cond_t wake;   ///< Сигнал о первом грязном рекорде или остановке
+  pthread_t thread;
+  int started;  ///< Фоновый поток запущен
+  int stop;     ///< Флаг остановки потока
+  int count;
+  HighScoreFile_t files[HIGHSCORE_MAX_FILES];
+  int run_count;  ///< Партий в очереди; лишние отбрасываются
+  HighScoreRun_t runs[HIGHSCORE_MAX_RUNS];
+  Leaderboard_t board;  ///< Таблица лучших (под io)
+  int board_open;
+} store = {.lock = PTHREAD_MUTEX_INITIALIZER,
+           .io = PTHREAD_MUTEX_INITIALIZER,
+           .wake = PTHREAD_COND_INITIALIZER};
+
+static int read_file(const char *path) {
+  int score = 0;
+  FILE *file = fopen(path, "rb");
+  if (file) {
+    if (fread(&score, sizeof(int), 1, file) != 1) {
+      score = 0;
+    }
+    fclose(file);
+  }
+  return score;
+}
+
+/**
+ * @brief Пишет рекорд во временный файл и подменяет им старый, чтобы сбой
+ * посреди записи не оставил пустой файл.
+ */
+static void write_file(const char *path, int score) {
+  char tmp[HIGHSCORE_PATH_MAX + sizeof(".tmp")];
+  int length = snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+  // Обрезанное имя указало бы на чужой файл
+  FILE *file = length > 0 && (size_t)length < sizeof(tmp) ? fopen(tmp, "wb")
+                                                          : NULL;
+  if (file) {
+    int written = fwrite(&score, sizeof(int), 1, file) == 1;
+    written = fclose(file) == 0 && written;
+    if (!written || rename(tmp, path) != 0) {
+      remove(tmp);
+    }
+  }
+}
+
+/**
+ * @brief Ищет файл в кэше, при первом обращении читает его. Вызывается под
+ * store.lock.
+ * @return Запись кэша или NULL, если кэш заполнен или путь слишком длинный.
+ */
+static HighScoreFile_t *find_file(const char *path) {
+  HighScoreFile_t *found = NULL;
+  for (int i = 0; i < store.count && !found; i++) {
+    if (strcmp(store.files[i].path, path) == 0) {
+      found = &store.files[i];
+    }
+  }
+  if (!found && store.count < HIGHSCORE_MAX_FILES &&
+      strlen(path) < HIGHSCORE_PATH_MAX) {
+    found = &store.files[store.count++];
+    strcpy(found->path, path);
+    found->score = read_file(path);
+    found->dirty = 0;
+  }
+  return found;
+}
+
+static int any_dirty(void) {
+  int dirty = store.run_count > 0;
+  for (int i = 0; i < store.count; i++) {
+    dirty |= store.files[i].dirty;
+  }
+  return dirty;
+}
+
+/**
+ * @brief Забирает грязные рекорды из кэша и записывает их.
+ */
+static void write_pending(void) {
+  HighScoreFile_t pending[HIGHSCORE_MAX_FILES];
+  HighScoreRun_t runs[HIGHSCORE_MAX_RUNS];
+  int count = 0;
+  pthread_mutex_lock(&store.io);
+  pthread_mutex_lock(&store.lock);
+  for (int i = 0; i < store.count; i++) {
+    if (store.files[i].dirty) {
+      pending[count++] = store.files[i];
+      store.files[i].dirty = 0;
+    }
+  }
+  int run_count = store.run_count;
+  memcpy(runs, store.runs, (size_t)run_count * sizeof(HighScoreRun_t));
+  store.run_count = 0;
+  pthread_mutex_unlock(&store.lock);
+
+  for (int i = 0; i < count; i++) {
+    write_file(pending[i].path, pending[i].score);
+  }
+  if (run_count && !store.board_open) {
+    store.board_open = leaderboard_open(&store.board, LEADERBOARD_FILE);
+  }
+  for (int i = 0; i < run_count && store.board_open; i++) {
+    leaderboard_submit(&store.board, runs[i].game, &runs[i].entry);
+  }
+  pthread_mutex_unlock(&store.io);
+}
+
+static struct timespec deadline_after(int ms) {
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  long nsec = deadline.tv_nsec + (ms % 1000) * 1000000L;
+  deadline.tv_sec += ms / 1000 + nsec / 1000000000L;
+  deadline.tv_nsec = nsec % 1000000000L;
+  return deadline;
+}
+
+/**
+ * @brief Фоновый поток: после первого нового рекорда ждет
+ * HIGHSCORE_FLUSH_MS (остальные рекорды за это время сливаются) и пишет.
+ */
+static void *writer(void *arg) {
+  (void)arg;
+  pthread_mutex_lock(&store.lock);
+  while (!store.stop) {
+    if (!any_dirty()) {
+      pthread_cond_wait(&store.wake, &store.lock);
+    } else {
+      struct timespec deadline = deadline_after(HIGHSCORE_FLUSH_MS);
+      int expired = 0;
+      while (!store.stop && !expired) {
+        expired = pthread_cond_timedwait(&store.wake, &store.lock,
+                                         &deadline) == ETIMEDOUT;
+      }
+      pthread_mutex_unlock(&store.lock);
+      write_pending();
+      pthread_mutex_lock(&store.lock);
+    }
+  }
+  pthread_mutex_unlock(&store.lock);
+  return NULL;
+}
+
+static void stop_writer(void) {
+  pthread_mutex_lock(&store.lock);
+  store.stop = 1;
+  pthread_cond_signal(&store.wake);
+  pthread_mutex_unlock(&store.lock);
+  pthread_join(store.thread, NULL);
+  write_pending();
+}
+
+/**
+ * @brief Запускает фоновый поток, если он еще не запущен. Вызывается под
+ * store.lock.
+ * @return 1, если поток работает.
+ */
+static int start_writer(void) {
+  if (!store.started) {
+    store.started = pthread_create(&store.thread, NULL, writer, NULL) == 0;
+    if (store.started) {
+      atexit(stop_writer);
+    }
+  }
+  return store.started;
+}
+
+int highscore_load(const char *path) {
+  pthread_mutex_lock(&store.lock);
+  HighScoreFile_t *file = find_file(path);
+  int score = file ? file->score : 0;
+  pthread_mutex_unlock(&store.lock);
+  return file ? score : read_file(path);
+}
+
+void highscore_submit(const char *path, int score) {
+  int sync = 0;
+  pthread_mutex_lock(&store.lock);
+  HighScoreFile_t *file = find_file(path);
+  if (file && score > file->score) {
+    file->score = score;
+    if (!file->dirty) {
+      file->dirty = 1;
+      pthread_cond_signal(&store.wake);
+    }
+    // Без фонового потока запись остается синхронной
+    sync = !start_writer();
+  }
+  pthread_mutex_unlock(&store.lock);
+  if (sync) {
+    write_pending();
+  } else if (!file && score > read_file(path)) {
+    write_file(path, score);
+  }
+}
+
+void highscore_finish(int game, int score, int level, uint64_t seed) {
+  int sync = 0;
+  pthread_mutex_lock(&store.lock);
+  if (store.run_count < HIGHSCORE_MAX_RUNS) {
+    HighScoreRun_t *run = &store.runs[store.run_count++];
+    run->game = game;
+    run->entry.score = score;
+    run->entry.level = level;
+    run->entry.timestamp = (int64_t)time(NULL);
+    run->entry.seed = seed;
+    pthread_cond_signal(&store.wake);
+    sync = !start_writer();
+  }
+  pthread_mutex_unlock(&store.lock);
+  if (sync) {
+    write_pending();
+  }
+}
+
+void highscore_flush(void) { write_pending(); }
+
+void highscore_reset(void) {
+  pthread_mutex_lock(&store.io);
+  pthread_mutex_lock(&store.lock);
+  store.count = 0;
+  store.run_count = 0;
+  pthread_mutex_unlock(&store.lock);
+  pthread_mutex_unlock(&store.io);
+}
@@ -0,0 +1,68 @@
+#ifndef HIGHSCORE_H
+#define HIGHSCORE_H
+
+#include <stdint.h>
+
+#include "leaderboard.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Рекорды игр. Файл рекорда читается один раз, дальше значение берется из
+ * памяти. Новый рекорд только помечает запись грязной: фоновый поток ждет
+ * HIGHSCORE_FLUSH_MS, собирая все обновления за это время, и записывает на
+ * диск последнее значение. При выходе из процесса несохраненное
+ * дописывается. Игровой шаг, таким образом, не трогает диск вовсе.
+ *
+ * Тем же потоком законченные партии попадают в общую таблицу лучших
+ * результатов LEADERBOARD_FILE.
+ */
+#define HIGHSCORE_FLUSH_MS 1000  ///< Задержка записи после нового рекорда
+#define HIGHSCORE_MAX_FILES 8    ///< Сколько файлов держится в кэше
+#define HIGHSCORE_PATH_MAX 256   ///< Наибольшая длина пути
+#define HIGHSCORE_MAX_RUNS 16    ///< Партий в очереди на запись в таблицу
+
+/**
+ * @brief Рекорд из файла; при первом обращении файл читается, затем
+ * значение берется из кэша.
+ * @param path Путь к файлу рекорда.
+ * @return Рекорд или 0, если файла нет.
+ */
+int highscore_load(const char *path);
+
+/**
+ * @brief Предлагает новый рекорд. Если он больше известного, кэш
+ * обновляется сразу, а запись в файл откладывается фоновому потоку.
+ * @param path Путь к файлу рекорда.
+ * @param score Счет.
+ */
+void highscore_submit(const char *path, int score);
+
+/**
+ * @brief Ставит законченную партию в очередь на запись в таблицу лучших.
+ * Время окончания берется в момент вызова.
+ * @param game Игра (ReplayGame_t).
+ * @param score Итоговый счет.
+ * @param level Уровень на момент окончания.
+ * @param seed Зерно партии.
+ */
+void highscore_finish(int game, int score, int level, uint64_t seed);
+
+/**
+ * @brief Записывает все отложенные рекорды в вызывающем потоке.
+ */
+void highscore_flush(void);
+
+/**
+ * @brief Забывает кэш и отложенные записи (для тестов, которые удаляют
+ * файлы рекордов). Дожидается записи, которая уже идет.
+ */
+void highscore_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // HIGHSCORE_H
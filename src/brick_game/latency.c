@@ -0,0 +1,142 @@
+#include "latency.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * @brief Гистограмма одного замера.
+ */
+typedef struct {
+  atomic_uint_fast64_t buckets[LATENCY_BUCKETS];
+  atomic_uint_fast64_t count;
+  atomic_uint_fast64_t sum;
+  atomic_uint_fast64_t max;
+} LatencyHistogram_t;
+
+static LatencyHistogram_t histograms[LATENCY_PROBES];
+static atomic_int dump_checked;
+
+static void dump_at_exit(void) { latency_dump(stderr); }
+
+/**
+ * @brief При первой записи регистрирует печать при выходе, если ее
+ * попросили через окружение.
+ */
+static void check_dump(void) {
+  if (!atomic_load_explicit(&dump_checked, memory_order_relaxed) &&
+      !atomic_exchange(&dump_checked, 1) && getenv("BRICK_LATENCY_DUMP")) {
+    atexit(dump_at_exit);
+  }
+}
+
+uint64_t latency_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+int latency_bucket(uint64_t ns) {
+  int bucket = (int)ns;
+  if (ns >= LATENCY_SUB_BUCKETS) {
+    // Старший бит задает степень, следующие LATENCY_SUB_BITS - корзину
+    int exponent = 63 - __builtin_clzll(ns);
+    int shift = exponent - LATENCY_SUB_BITS;
+    bucket = (shift + 1) * LATENCY_SUB_BUCKETS +
+             (int)(ns >> shift) - LATENCY_SUB_BUCKETS;
+  }
+  return bucket;
+}
+
+uint64_t latency_bucket_limit(int bucket) {
+  uint64_t limit = (uint64_t)bucket;
+  if (bucket >= LATENCY_SUB_BUCKETS) {
+    int shift = bucket / LATENCY_SUB_BUCKETS - 1;
+    uint64_t mantissa = (uint64_t)(bucket % LATENCY_SUB_BUCKETS) + 1;
+    // У последней корзины сдвиг дает 2^64 = 0, и граница - UINT64_MAX
+    limit = ((mantissa + LATENCY_SUB_BUCKETS) << shift) - 1;
+  }
+  return limit;
+}
+
+void latency_record(LatencyProbe_t probe, uint64_t ns) {
+  LatencyHistogram_t *histogram = &histograms[probe];
+  check_dump();
+  atomic_fetch_add_explicit(&histogram->buckets[latency_bucket(ns)], 1,
+                            memory_order_relaxed);
+  atomic_fetch_add_explicit(&histogram->count, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&histogram->sum, ns, memory_order_relaxed);
+  uint_fast64_t max =
+      atomic_load_explicit(&histogram->max, memory_order_relaxed);
+  while (ns > max && !atomic_compare_exchange_weak_explicit(
+                         &histogram->max, &max, ns, memory_order_relaxed,
+                         memory_order_relaxed)) {
+  }
+}
+
+/**
+ * @brief Верхняя граница корзины, в которой лежит заданная доля вызовов.
+ */
+static uint64_t percentile(const LatencyHistogram_t *histogram, uint64_t count,
+                           uint64_t max, int percent) {
+  // Ранг вызова, начиная с 1: ceil(count * percent / 100)
+  uint64_t rank = (count * (uint64_t)percent + 99) / 100;
+  uint64_t seen = 0;
+  int bucket = 0;
+  while (bucket < LATENCY_BUCKETS - 1 && seen < rank) {
+    seen += atomic_load_explicit(&histogram->buckets[bucket],
+                                 memory_order_relaxed);
+    bucket += seen < rank;
+  }
+  uint64_t limit = latency_bucket_limit(bucket);
+  return limit < max ? limit : max;
+}
+
+int latency_stats(LatencyProbe_t probe, LatencyStats_t *stats) {
+  const LatencyHistogram_t *histogram = &histograms[probe];
+  LatencyStats_t null_stats = {0};
+  *stats = null_stats;
+  stats->count = atomic_load_explicit(&histogram->count, memory_order_relaxed);
+  if (stats->count) {
+    stats->max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+    stats->mean =
+        (double)atomic_load_explicit(&histogram->sum, memory_order_relaxed) /
+        (double)stats->count;
+    stats->p50 = percentile(histogram, stats->count, stats->max, 50);
+    stats->p99 = percentile(histogram, stats->count, stats->max, 99);
+  }
+  return stats->count != 0;
+}
+
+void latency_reset(void) {
+  for (int probe = 0; probe < LATENCY_PROBES; probe++) {
+    LatencyHistogram_t *histogram = &histograms[probe];
+    for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+      atomic_store(&histogram->buckets[bucket], 0);
+    }
+    atomic_store(&histogram->count, 0);
+    atomic_store(&histogram->sum, 0);
+    atomic_store(&histogram->max, 0);
+  }
+}
+
+void latency_dump(FILE *file) {
+  fprintf(file, "%-20s %10s %10s %10s %10s %12s\n", "latency, ns", "calls",
+          "mean", "p50", "p99", "max");
+  for (int probe = 0; probe < LATENCY_PROBES; probe++) {
+    LatencyStats_t stats;
+    if (latency_stats((LatencyProbe_t)probe, &stats)) {
+      fprintf(file, "%-20s %10llu %10.0f %10llu %10llu %12llu\n",
+              latency_name((LatencyProbe_t)probe),
+              (unsigned long long)stats.count, stats.mean,
+              (unsigned long long)stats.p50, (unsigned long long)stats.p99,
+              (unsigned long long)stats.max);
+    }
+  }
+}
+
+const char *latency_name(LatencyProbe_t probe) {
+  static const char *const names[LATENCY_PROBES] = {"userInput", "update",
+                                                    "updateCurrentState"};
+  return probe >= 0 && probe < LATENCY_PROBES ? names[probe] : "?";
+}
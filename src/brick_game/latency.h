@@ -0,0 +1,107 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Гистограммы длительности вызовов движка. Длительность в наносекундах
+ * попадает в логарифмически-линейную корзину: значения меньше
+ * LATENCY_SUB_BUCKETS хранятся точно, остальные - в одной из
+ * LATENCY_SUB_BUCKETS корзин своей степени двойки, то есть с
+ * относительной ошибкой не больше 1 / LATENCY_SUB_BUCKETS. Корзины
+ * фиксированы, поэтому запись - это пара атомарных сложений без выделения
+ * памяти и без блокировок.
+ *
+ * Замеры включаются при сборке с BRICK_LATENCY (опция CMake
+ * -DBRICK_LATENCY=ON). Без нее LATENCY_BEGIN/LATENCY_END раскрываются в
+ * пустоту и движки не делают ни одного лишнего вызова. Если задана
+ * переменная окружения BRICK_LATENCY_DUMP, при выходе из процесса
+ * гистограммы печатаются в stderr.
+ */
+#define LATENCY_SUB_BITS 4
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_BUCKETS ((64 - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+/**
+ * @brief Замеряемый вызов.
+ */
+typedef enum {
+  Latency_input,   ///< userInput()
+  Latency_update,  ///< Шаг движка: SnakeGame::update(), core_step()
+  Latency_state,   ///< updateCurrentState()
+  LATENCY_PROBES   ///< Количество замеров
+} LatencyProbe_t;
+
+/**
+ * @brief Сводка по одной гистограмме (все времена в наносекундах).
+ */
+typedef struct {
+  uint64_t count;  ///< Количество вызовов
+  uint64_t p50;    ///< Медиана (верхняя граница корзины)
+  uint64_t p99;    ///< 99-й процентиль (верхняя граница корзины)
+  uint64_t max;    ///< Самый долгий вызов (точно)
+  double mean;     ///< Среднее
+} LatencyStats_t;
+
+#ifdef BRICK_LATENCY
+#define LATENCY_BEGIN(probe) uint64_t latency_start_##probe = latency_now()
+#define LATENCY_END(probe) \
+  latency_record(probe, latency_now() - latency_start_##probe)
+#else
+#define LATENCY_BEGIN(probe)
+#define LATENCY_END(probe)
+#endif
+
+/**
+ * @brief Монотонное время в наносекундах.
+ */
+uint64_t latency_now(void);
+
+/**
+ * @brief Номер корзины для длительности.
+ */
+int latency_bucket(uint64_t ns);
+
+/**
+ * @brief Наибольшая длительность, попадающая в корзину.
+ */
+uint64_t latency_bucket_limit(int bucket);
+
+/**
+ * @brief Добавляет длительность вызова в гистограмму. Потокобезопасна.
+ * @param probe Замер (LatencyProbe_t).
+ * @param ns Длительность в наносекундах.
+ */
+void latency_record(LatencyProbe_t probe, uint64_t ns);
+
+/**
+ * @brief Считает сводку по гистограмме.
+ * @return 1, если в гистограмме есть хотя бы один вызов.
+ */
+int latency_stats(LatencyProbe_t probe, LatencyStats_t *stats);
+
+/**
+ * @brief Обнуляет все гистограммы.
+ */
+void latency_reset(void);
+
+/**
+ * @brief Печатает сводку по всем непустым гистограммам.
+ */
+void latency_dump(FILE *file);
+
+/**
+ * @brief Имя замера для вывода.
+ */
+const char *latency_name(LatencyProbe_t probe);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LATENCY_H
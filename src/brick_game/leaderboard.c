@@ -0,0 +1,211 @@
+#include "leaderboard.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define LEADERBOARD_SUFFIX_MAX 8  ///< Место под ".lock" и ".tmp" за путем
+
+static uint32_t fnv1a(const void *data, size_t size) {
+  const uint8_t *bytes = data;
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+uint32_t leaderboard_checksum(const LeaderboardFile_t *file) {
+  return fnv1a(file->tables, sizeof(file->tables));
+}
+
+static int is_valid(const LeaderboardFile_t *file) {
+  int valid = memcmp(file->magic, LEADERBOARD_MAGIC, 4) == 0 &&
+              file->version == LEADERBOARD_VERSION &&
+              file->size == LEADERBOARD_SIZE &&
+              file->checksum == leaderboard_checksum(file);
+  for (int game = 0; game < LEADERBOARD_GAMES && valid; game++) {
+    valid = file->tables[game].count <= LEADERBOARD_SIZE;
+  }
+  return valid;
+}
+
+/**
+ * @brief Отображает файл в память, если он целый.
+ * @return Отображение или NULL.
+ */
+static const LeaderboardFile_t *map_file(const char *path, uint64_t *inode) {
+  const LeaderboardFile_t *map = NULL;
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  struct stat st;
+  if (fd >= 0 && fstat(fd, &st) == 0 &&
+      st.st_size == (off_t)sizeof(LeaderboardFile_t)) {
+    void *data = mmap(NULL, sizeof(LeaderboardFile_t), PROT_READ, MAP_SHARED,
+                      fd, 0);
+    map = data == MAP_FAILED ? NULL : data;
+    *inode = (uint64_t)st.st_ino;
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+  if (map && !is_valid(map)) {
+    munmap((void *)map, sizeof(LeaderboardFile_t));
+    map = NULL;
+  }
+  return map;
+}
+
+static void unmap(Leaderboard_t *board) {
+  if (board->map) {
+    munmap((void *)board->map, sizeof(LeaderboardFile_t));
+    board->map = NULL;
+  }
+}
+
+int leaderboard_open(Leaderboard_t *board, const char *path) {
+  Leaderboard_t null_board = {0};
+  *board = null_board;
+  int result = strlen(path) < LEADERBOARD_PATH_MAX;
+  if (result) {
+    strcpy(board->path, path);
+    leaderboard_refresh(board);
+  }
+  return result;
+}
+
+void leaderboard_close(Leaderboard_t *board) { unmap(board); }
+
+int leaderboard_refresh(Leaderboard_t *board) {
+  // Файл подменяется только через rename(), поэтому новый файл - это
+  // новый inode. Отображенный старый inode занят, номер не повторится
+  struct stat st;
+  int exists = stat(board->path, &st) == 0;
+  if (!exists || !board->map || (uint64_t)st.st_ino != board->inode) {
+    unmap(board);
+    board->map = exists ? map_file(board->path, &board->inode) : NULL;
+  }
+  return board->map != NULL;
+}
+
+const LeaderboardEntry_t *leaderboard_entries(const Leaderboard_t *board,
+                                              int game, int *count) {
+  const LeaderboardEntry_t *entries = NULL;
+  *count = 0;
+  if (board->map && game >= 0 && game < LEADERBOARD_GAMES &&
+      board->map->tables[game].count) {
+    *count = (int)board->map->tables[game].count;
+    entries = board->map->tables[game].entries;
+  }
+  return entries;
+}
+
+/**
+ * @brief Вставляет запись после всех записей с не меньшим счетом.
+ * @return Место (с 1) или 0, если запись не попала в таблицу.
+ */
+static int insert(LeaderboardTable_t *table, const LeaderboardEntry_t *entry) {
+  int count = (int)table->count;
+  int pos = count;
+  while (pos > 0 && table->entries[pos - 1].score < entry->score) {
+    pos--;
+  }
+  int rank = 0;
+  if (pos < LEADERBOARD_SIZE) {
+    int kept = count < LEADERBOARD_SIZE ? count : LEADERBOARD_SIZE - 1;
+    memmove(&table->entries[pos + 1], &table->entries[pos],
+            (size_t)(kept - pos) * sizeof(LeaderboardEntry_t));
+    table->entries[pos] = *entry;
+    table->count = (uint32_t)(kept + 1);
+    rank = pos + 1;
+  }
+  return rank;
+}
+
+/**
+ * @brief Синхронизирует каталог файла, чтобы rename() пережил сбой.
+ */
+static void sync_directory(const char *path) {
+  char dir[LEADERBOARD_PATH_MAX];
+  const char *slash = strrchr(path, '/');
+  if (slash) {
+    size_t size = slash == path ? 1 : (size_t)(slash - path);
+    memcpy(dir, path, size);
+    dir[size] = '\0';
+  } else {
+    strcpy(dir, ".");
+  }
+  int fd = open(dir, O_RDONLY | O_CLOEXEC);
+  if (fd >= 0) {
+    fsync(fd);
+    close(fd);
+  }
+}
+
+/**
+ * @brief Пишет таблицу во временный файл и подменяет ею основной.
+ * @return 1 при успехе.
+ */
+static int write_atomically(const char *path, const LeaderboardFile_t *file) {
+  char tmp[LEADERBOARD_PATH_MAX + LEADERBOARD_SUFFIX_MAX];
+  snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+  int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  int result = fd >= 0;
+  if (result) {
+    result = write(fd, file, sizeof(*file)) == (ssize_t)sizeof(*file) &&
+             fsync(fd) == 0;
+    result = close(fd) == 0 && result;
+    result = result && rename(tmp, path) == 0;
+    if (!result) {
+      unlink(tmp);
+    }
+  }
+  if (result) {
+    sync_directory(path);
+  }
+  return result;
+}
+
+int leaderboard_submit(Leaderboard_t *board, int game,
+                       const LeaderboardEntry_t *entry) {
+  int result = game >= 0 && game < LEADERBOARD_GAMES ? 0 : -1;
+
+  // Минимум полной таблицы со временем только растет, поэтому если
+  // результат не проходит даже по старому отображению, файл не нужен
+  int count = 0;
+  const LeaderboardEntry_t *entries = leaderboard_entries(board, game, &count);
+  int skip = result || (count == LEADERBOARD_SIZE &&
+                        entry->score <= entries[count - 1].score);
+
+  char lock_path[LEADERBOARD_PATH_MAX + LEADERBOARD_SUFFIX_MAX];
+  snprintf(lock_path, sizeof(lock_path), "%s.lock", board->path);
+  int lock = skip ? -1 : open(lock_path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (!skip && (lock < 0 || flock(lock, LOCK_EX) != 0)) {
+    result = -1;
+  } else if (!skip) {
+    LeaderboardFile_t next;
+    if (leaderboard_refresh(board)) {
+      next = *board->map;
+    } else {
+      LeaderboardFile_t null_file = {0};
+      next = null_file;
+      memcpy(next.magic, LEADERBOARD_MAGIC, 4);
+      next.version = LEADERBOARD_VERSION;
+      next.size = LEADERBOARD_SIZE;
+    }
+    result = insert(&next.tables[game], entry);
+    if (result) {
+      next.checksum = leaderboard_checksum(&next);
+      result = write_atomically(board->path, &next) ? result : -1;
+      leaderboard_refresh(board);
+    }
+  }
+  if (lock >= 0) {
+    // Закрытие снимает flock
+    close(lock);
+  }
+  return result;
+}
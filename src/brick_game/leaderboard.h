@@ -0,0 +1,114 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Общая таблица лучших результатов обеих игр. Файл фиксированного размера
+ * отображается в память только для чтения, поэтому читатели получают
+ * записи без копирования. Файл никогда не меняется на месте: новая таблица
+ * пишется во временный файл, синхронизируется на диск и подменяет старую
+ * через rename(), так что после сбоя на диске лежит либо старая, либо
+ * новая таблица целиком. Обновления нескольких процессов упорядочиваются
+ * flock() на соседнем файле path.lock, а контрольная сумма отсекает чужие
+ * и поврежденные файлы.
+ */
+#define LEADERBOARD_MAGIC "BGLB"
+#define LEADERBOARD_VERSION 1
+#define LEADERBOARD_SIZE 10       ///< Записей в таблице одной игры
+#define LEADERBOARD_GAMES 2       ///< Игр в файле (ReplayGame_t)
+#define LEADERBOARD_PATH_MAX 256  ///< Наибольшая длина пути
+
+/// Файл, в который игры записывают свои результаты
+#define LEADERBOARD_FILE "leaderboard.dat"
+
+/**
+ * @brief Одна запись таблицы.
+ */
+typedef struct {
+  int32_t score;
+  int32_t level;
+  int64_t timestamp;  ///< Время окончания партии, секунды Unix
+  uint64_t seed;      ///< Зерно партии (для повтора)
+} LeaderboardEntry_t;
+
+/**
+ * @brief Таблица одной игры, записи по убыванию счета.
+ */
+typedef struct {
+  uint32_t count;
+  uint32_t reserved;
+  LeaderboardEntry_t entries[LEADERBOARD_SIZE];
+} LeaderboardTable_t;
+
+/**
+ * @brief Содержимое файла.
+ */
+typedef struct {
+  char magic[4];
+  uint32_t version;
+  uint32_t size;      ///< LEADERBOARD_SIZE на момент записи
+  uint32_t checksum;  ///< FNV-1a по tables
+  LeaderboardTable_t tables[LEADERBOARD_GAMES];
+} LeaderboardFile_t;
+
+/**
+ * @brief Открытая таблица: путь и текущее отображение файла.
+ */
+typedef struct {
+  char path[LEADERBOARD_PATH_MAX];
+  const LeaderboardFile_t *map;  ///< NULL, если файла нет или он поврежден
+  uint64_t inode;                ///< Отображенный файл
+} Leaderboard_t;
+
+/**
+ * @brief Открывает таблицу и отображает файл, если он есть.
+ * @return 1, если путь подходит (файла может и не быть), 0 иначе.
+ */
+int leaderboard_open(Leaderboard_t *board, const char *path);
+
+/**
+ * @brief Снимает отображение.
+ */
+void leaderboard_close(Leaderboard_t *board);
+
+/**
+ * @brief Перечитывает файл, если его подменил другой процесс.
+ * @return 1, если отображена корректная таблица.
+ */
+int leaderboard_refresh(Leaderboard_t *board);
+
+/**
+ * @brief Записи игры прямо из отображения; действительны до следующего
+ * leaderboard_refresh(), leaderboard_submit() или leaderboard_close().
+ * @param game Игра (ReplayGame_t).
+ * @param count Количество записей.
+ * @return Указатель на первую запись или NULL, если записей нет.
+ */
+const LeaderboardEntry_t *leaderboard_entries(const Leaderboard_t *board,
+                                              int game, int *count);
+
+/**
+ * @brief Добавляет результат партии, если он попадает в таблицу.
+ * Безопасна при одновременных вызовах из нескольких процессов.
+ * @param game Игра (ReplayGame_t).
+ * @return Место в таблице (с 1), 0 если результат не попал в таблицу, -1
+ * при ошибке записи.
+ */
+int leaderboard_submit(Leaderboard_t *board, int game,
+                       const LeaderboardEntry_t *entry);
+
+/**
+ * @brief Контрольная сумма таблиц файла.
+ */
+uint32_t leaderboard_checksum(const LeaderboardFile_t *file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LEADERBOARD_H
@@ -0,0 +1,206 @@
+#include "replay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_MAGIC "BGRP"
+#define REPLAY_ACTION_MASK ((1u << REPLAY_ACTION_BITS) - 1)
+#define REPLAY_MAX_VARINT 10  ///< Байт в самом длинном varint (64 бита)
+#define REPLAY_MAX_DATA (1u << 30)  ///< Ограничение на размер при загрузке
+
+#define BOARD_HEIGHT 20
+#define BOARD_WIDTH 10
+
+/**
+ * @brief Дописывает varint: по 7 бит в байте, старший бит - продолжение.
+ */
+static size_t put_varint(uint8_t *out, uint64_t value) {
+  size_t size = 0;
+  while (value >= 0x80) {
+    out[size++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[size++] = (uint8_t)value;
+  return size;
+}
+
+/**
+ * @brief Читает varint из буфера.
+ * @return Количество прочитанных байт или 0, если varint оборван.
+ */
+static size_t get_varint(const uint8_t *in, size_t size, uint64_t *value) {
+  size_t pos = 0;
+  int shift = 0;
+  int more = 1;
+  *value = 0;
+  while (more && pos < size && shift < 64) {
+    *value |= (uint64_t)(in[pos] & 0x7F) << shift;
+    more = in[pos++] & 0x80;
+    shift += 7;
+  }
+  return more ? 0 : pos;
+}
+
+static int write_varint(FILE *file, uint64_t value) {
+  uint8_t buffer[REPLAY_MAX_VARINT];
+  size_t size = put_varint(buffer, value);
+  return fwrite(buffer, 1, size, file) == size;
+}
+
+static int read_varint(FILE *file, uint64_t *value) {
+  int shift = 0;
+  int ch = 0x80;
+  *value = 0;
+  while ((ch & 0x80) && shift < 64 && (ch = fgetc(file)) != EOF) {
+    *value |= (uint64_t)(ch & 0x7F) << shift;
+    shift += 7;
+  }
+  return ch != EOF && !(ch & 0x80);
+}
+
+void replay_init(Replay_t *replay, int game, uint64_t seed) {
+  Replay_t null_replay = {0};
+  *replay = null_replay;
+  replay->game = game;
+  replay->seed = seed;
+}
+
+void replay_free(Replay_t *replay) {
+  free(replay->data);
+  replay->data = NULL;
+  replay->size = 0;
+  replay->capacity = 0;
+}
+
+int replay_record(Replay_t *replay, long tick, UserAction_t action) {
+  int result = 1;
+  if (replay->size + REPLAY_MAX_VARINT > replay->capacity) {
+    size_t capacity = replay->capacity ? replay->capacity * 2 : 256;
+    uint8_t *data = realloc(replay->data, capacity);
+    if (data) {
+      replay->data = data;
+      replay->capacity = capacity;
+    } else {
+      result = 0;
+    }
+  }
+  if (result) {
+    uint64_t delta = (uint64_t)(tick - replay->last_tick);
+    replay->size += put_varint(replay->data + replay->size,
+                               delta << REPLAY_ACTION_BITS | (unsigned)action);
+    replay->last_tick = tick;
+    replay->events++;
+  }
+  return result;
+}
+
+void replay_finish(Replay_t *replay, long ticks, const GameInfo_t *info) {
+  replay->ticks = ticks;
+  replay->score = info->score;
+  replay->board_hash = replay_board_hash(info);
+}
+
+int replay_save(const Replay_t *replay, const char *path) {
+  FILE *file = fopen(path, "wb");
+  int result = file != NULL;
+  if (result) {
+    result = fwrite(REPLAY_MAGIC, 1, 4, file) == 4 &&
+             write_varint(file, REPLAY_VERSION) &&
+             write_varint(file, (uint64_t)replay->game) &&
+             write_varint(file, replay->seed) &&
+             write_varint(file, (uint64_t)replay->tick_ms) &&
+             write_varint(file, (uint64_t)replay->rules) &&
+             write_varint(file, (uint64_t)replay->ticks) &&
+             write_varint(file, (uint64_t)replay->score) &&
+             write_varint(file, replay->board_hash) &&
+             write_varint(file, (uint64_t)replay->events) &&
+             write_varint(file, replay->size) &&
+             fwrite(replay->data, 1, replay->size, file) == replay->size;
+    result = fclose(file) == 0 && result;
+  }
+  return result;
+}
+
+int replay_load(Replay_t *replay, const char *path) {
+  replay_init(replay, Replay_tetris, 0);
+  FILE *file = fopen(path, "rb");
+  int result = file != NULL;
+  if (result) {
+    char magic[4];
+    uint64_t version, game, tick_ms, rules, ticks, score, hash, events, size;
+    result = fread(magic, 1, 4, file) == 4 &&
+             memcmp(magic, REPLAY_MAGIC, 4) == 0 &&
+             read_varint(file, &version) && version == REPLAY_VERSION &&
+             read_varint(file, &game) && read_varint(file, &replay->seed) &&
+             read_varint(file, &tick_ms) && read_varint(file, &rules) &&
+             read_varint(file, &ticks) && read_varint(file, &score) &&
+             read_varint(file, &hash) && read_varint(file, &events) &&
+             read_varint(file, &size) && size <= REPLAY_MAX_DATA;
+    if (result) {
+      replay->game = (int)game;
+      replay->tick_ms = (int)tick_ms;
+      replay->rules = (int)rules;
+      replay->ticks = (long)ticks;
+      replay->score = (int)score;
+      replay->board_hash = (uint32_t)hash;
+      replay->events = (long)events;
+      replay->data = malloc(size ? size : 1);
+      replay->capacity = size;
+      result = replay->data != NULL &&
+               fread(replay->data, 1, size, file) == size;
+      replay->size = result ? size : 0;
+    }
+    fclose(file);
+  }
+
+  // Поток событий должен разбираться целиком и давать заявленное число
+  ReplayCursor_t cursor;
+  long tick;
+  UserAction_t action;
+  long events = 0;
+  replay_cursor(&cursor, replay);
+  while (result && replay_next(&cursor, &tick, &action)) {
+    events++;
+  }
+  result = result && cursor.pos == replay->size && events == replay->events;
+  if (result) {
+    replay->last_tick = cursor.tick;
+  } else {
+    replay_free(replay);
+  }
+  return result;
+}
+
+void replay_cursor(ReplayCursor_t *cursor, const Replay_t *replay) {
+  cursor->replay = replay;
+  cursor->pos = 0;
+  cursor->tick = 0;
+}
+
+int replay_next(ReplayCursor_t *cursor, long *tick, UserAction_t *action) {
+  const Replay_t *replay = cursor->replay;
+  uint64_t value = 0;
+  size_t size = 0;
+  if (cursor->pos < replay->size) {
+    size = get_varint(replay->data + cursor->pos, replay->size - cursor->pos,
+                      &value);
+  }
+  if (size) {
+    cursor->pos += size;
+    cursor->tick += (long)(value >> REPLAY_ACTION_BITS);
+    *tick = cursor->tick;
+    *action = (UserAction_t)(value & REPLAY_ACTION_MASK);
+  }
+  return size != 0;
+}
+
+uint32_t replay_board_hash(const GameInfo_t *info) {
+  uint32_t hash = 2166136261u;
+  for (int i = 0; i < BOARD_HEIGHT && info->field; i++) {
+    for (int j = 0; j < BOARD_WIDTH; j++) {
+      hash = (hash ^ (uint32_t)info->field[i][j]) * 16777619u;
+    }
+  }
+  return hash;
+}
@@ -0,0 +1,137 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Запись партии - зерно генератора и поток событий (шаг, действие). Шаг -
+ * число обновлений движка, выполненных до ввода. Каждое событие кодируется
+ * одним varint: (шаг - шаг предыдущего события) << 3 | действие, поэтому
+ * частые нажатия занимают по байту.
+ */
+#define REPLAY_ACTION_BITS 3
+#define REPLAY_VERSION 2
+
+/**
+ * @brief Игра, к которой относится запись.
+ */
+typedef enum {
+  Replay_tetris,  ///< Тетрис (шаг - вызов tetris_step())
+  Replay_snake    ///< Змейка (шаг - вызов SnakeGame::update())
+} ReplayGame_t;
+
+/**
+ * @brief Запись партии в памяти.
+ */
+typedef struct {
+  int game;             ///< Игра (ReplayGame_t)
+  uint64_t seed;        ///< Зерно генератора партии
+  int tick_ms;          ///< Шаг виртуальных часов (для тетриса)
+  int rules;            ///< Вариант правил (для тетриса - Randomizer_t)
+  long ticks;           ///< Шагов к моменту окончания записи
+  int score;            ///< Итоговый счет
+  uint32_t board_hash;  ///< Хэш итогового поля (replay_board_hash())
+  long events;          ///< Количество событий
+  long last_tick;       ///< Шаг последнего события
+  uint8_t *data;        ///< Закодированные события
+  size_t size;          ///< Занятый размер data
+  size_t capacity;      ///< Выделенный размер data
+} Replay_t;
+
+/**
+ * @brief Итог воспроизведения.
+ */
+typedef struct {
+  long ticks;           ///< Выполнено шагов
+  int score;            ///< Итоговый счет
+  uint32_t board_hash;  ///< Хэш итогового поля
+  int matches;          ///< 1, если счет и поле совпали с записью
+} ReplayResult_t;
+
+/**
+ * @brief Позиция чтения событий записи.
+ */
+typedef struct {
+  const Replay_t *replay;
+  size_t pos;  ///< Смещение следующего события в data
+  long tick;   ///< Шаг предыдущего события
+} ReplayCursor_t;
+
+/**
+ * @brief Начинает пустую запись.
+ * @param replay Запись.
+ * @param game Игра (ReplayGame_t).
+ * @param seed Зерно генератора партии.
+ */
+void replay_init(Replay_t *replay, int game, uint64_t seed);
+
+/**
+ * @brief Освобождает буфер событий.
+ * @param replay Запись.
+ */
+void replay_free(Replay_t *replay);
+
+/**
+ * @brief Добавляет событие.
+ * @param replay Запись.
+ * @param tick Шаг, не меньше шага предыдущего события.
+ * @param action Действие пользователя.
+ * @return 1 при успехе, 0 если не хватило памяти.
+ */
+int replay_record(Replay_t *replay, long tick, UserAction_t action);
+
+/**
+ * @brief Запоминает итог партии для проверки при воспроизведении.
+ * @param replay Запись.
+ * @param ticks Шагов к моменту окончания.
+ * @param info Итоговое состояние (счет и поле).
+ */
+void replay_finish(Replay_t *replay, long ticks, const GameInfo_t *info);
+
+/**
+ * @brief Сохраняет запись в файл.
+ * @return 1 при успехе, 0 при ошибке записи.
+ */
+int replay_save(const Replay_t *replay, const char *path);
+
+/**
+ * @brief Загружает запись из файла.
+ * @param replay Запись; при успехе освобождается через replay_free().
+ * @return 1 при успехе, 0 если файла нет или он поврежден.
+ */
+int replay_load(Replay_t *replay, const char *path);
+
+/**
+ * @brief Устанавливает курсор на первое событие записи.
+ */
+void replay_cursor(ReplayCursor_t *cursor, const Replay_t *replay);
+
+/**
+ * @brief Читает следующее событие.
+ * @param cursor Курсор.
+ * @param tick Шаг события.
+ * @param action Действие.
+ * @return 1, если событие прочитано, 0 в конце записи.
+ */
+int replay_next(ReplayCursor_t *cursor, long *tick, UserAction_t *action);
+
+/**
+ * @brief Хэш FNV-1a клеток игрового поля 20x10 из GameInfo_t.
+ * @param info Состояние игры (field может быть NULL).
+ * @return Хэш поля.
+ */
+uint32_t replay_board_hash(const GameInfo_t *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // REPLAY_H
@@ -2,31 +2,37 @@
 
 namespace s21 {
 
-void Apple::spawn(const Field& field, const Snake& snake) {
-  position_ = findValidPosition(field, snake);
+void Apple::seed(std::uint64_t seed) {
+  std::seed_seq sequence{static_cast<std::uint32_t>(seed),
+                         static_cast<std::uint32_t>(seed >> 32)};
+  rng_.seed(sequence);
 }
 
-Point Apple::findValidPosition(const Field& field, const Snake& snake) const {
-  std::vector<Point> valid_positions;
+bool Apple::spawn(const Field& field, const Snake& snake) {
+  std::optional<Point> position = findValidPosition(field, snake);
+  position_ = position.value_or(Point(-1, -1));
+  return position.has_value();
+}
 
-  // Собираем все свободные позиции
-  for (int y = 0; y < Field::HEIGHT; ++y) {
-    for (int x = 0; x < Field::WIDTH; ++x) {
-      Point pos(x, y);
-      if (field.isEmpty(pos) && !snake.contains(pos)) {
-        valid_positions.push_back(pos);
-      }
-    }
+std::optional<Point> Apple::findValidPosition(const Field& field,
+                                              const Snake& snake) const {
+  int count = field.getFreeCount();
+  if (count == 0) {
+    return std::nullopt;
   }
 
-  if (valid_positions.empty()) {
-    // Если нет свободных позиций, возвращаем первую клетку
-    return Point(0, 0);
+  // Выбираем случайную свободную клетку. Если змейка отрисована на поле,
+  // первая же клетка подходит; иначе идем по индексу до первой клетки вне
+  // змейки
+  std::uniform_int_distribution<> dist(0, count - 1);
+  int start = dist(rng_);
+  for (int i = 0; i < count; ++i) {
+    Point pos = field.getFreeCell((start + i) % count);
+    if (!snake.contains(pos)) {
+      return pos;
+    }
   }
-
-  // Выбираем случайную позицию
-  std::uniform_int_distribution<> dist(0, valid_positions.size() - 1);
-  return valid_positions[dist(rng_)];
+  return std::nullopt;
 }
 
-}  // namespace s21
\ No newline at end of file
+}  // namespace s21
@@ -1,6 +1,8 @@
 #ifndef APPLE_H
 #define APPLE_H
 
+#include <cstdint>
+#include <optional>
 #include <random>
 
 #include "field.h"
@@ -13,7 +15,12 @@ class Apple {
  public:
   Apple() : rng_(std::random_device{}()) {}
 
-  void spawn(const Field& field, const Snake& snake);
+  // Фиксирует последовательность позиций яблока (для записей партий)
+  void seed(std::uint64_t seed);
+
+  // Возвращает false, если свободных клеток не осталось; яблоко тогда
+  // убирается за пределы поля
+  bool spawn(const Field& field, const Snake& snake);
   const Point& getPosition() const { return position_; }
   // cppcheck-suppress unusedFunction
   void setPosition(const Point& point) { position_ = point; }
@@ -22,7 +29,8 @@ class Apple {
   Point position_;
   mutable std::mt19937 rng_;
 
-  Point findValidPosition(const Field& field, const Snake& snake) const;
+  std::optional<Point> findValidPosition(const Field& field,
+                                         const Snake& snake) const;
 };
 
 }  // namespace s21
@@ -0,0 +1,196 @@
+#include "autopilot.h"
+
+#include <cstdlib>
+
+#include "snake_game.h"
+#include "states/playing_state.h"
+
+namespace s21 {
+
+namespace {
+
+constexpr Snake::Direction DIRECTIONS[] = {
+    Snake::Direction::UP, Snake::Direction::RIGHT, Snake::Direction::DOWN,
+    Snake::Direction::LEFT};
+constexpr int DX[] = {0, 1, 0, -1};
+constexpr int DY[] = {-1, 0, 1, 0};
+
+// Ход змейки длится не больше BASE_SPEED_DELAY обновлений
+constexpr int MAX_UPDATES_PER_MOVE = 64;
+
+}  // namespace
+
+UserAction_t Autopilot::decide(const SnakeGame& game) {
+  switch (chooseDirection(game.getSnake(), game.getApple().getPosition())) {
+    case Snake::Direction::UP:
+      return Up;
+    case Snake::Direction::DOWN:
+      return Down;
+    case Snake::Direction::LEFT:
+      return Left;
+    default:
+      return Right;
+  }
+}
+
+Snake::Direction Autopilot::chooseDirection(const Snake& snake,
+                                            const Point& apple) {
+  prepare(snake);
+  int head = cellIndex(snake.getHead());
+  int target = cellIndex(apple);
+
+  // Кратчайший путь к яблоку, если после него хвост остается достижимым
+  int length = (head != NO_CELL && target != NO_CELL) ? findPath(head, target)
+                                                      : NO_CELL;
+  if (length > 0) {
+    int cell = target;
+    for (int i = length - 1; i >= 0; --i) {
+      path_[i] = static_cast<std::uint8_t>(cell);
+      cell = came_from_[cell];
+    }
+    if (simulate(snake, length, true).tail_reachable) {
+      int dx = path_[0] % Field::WIDTH - head % Field::WIDTH;
+      int dy = path_[0] / Field::WIDTH - head / Field::WIDTH;
+      for (int d = 0; d < 4; ++d) {
+        if (DX[d] == dx && DY[d] == dy) return DIRECTIONS[d];
+      }
+    }
+  }
+
+  // Иначе ход, после которого хвост достижим и места больше всего
+  Snake::Direction best = snake.getNextDirection();
+  int best_score = -1;
+  Point head_point = snake.getHead();
+  fallback_turn_ = (fallback_turn_ + 1) & 3;
+  for (int k = 0; k < 4; ++k) {
+    int d = (fallback_turn_ + k) & 3;
+    Point next(head_point.x + DX[d], head_point.y + DY[d]);
+    int index = cellIndex(next);
+    bool grow = next == apple;
+    if (index != NO_CELL && snake.isValidDirectionChange(DIRECTIONS[d]) &&
+        free_at_[index] <= (grow ? 0 : 1)) {
+      path_[0] = static_cast<std::uint8_t>(index);
+      FillResult fill = simulate(snake, 1, grow);
+      int score = fill.area + (fill.tail_reachable ? Field::CELLS : 0);
+      if (score > best_score) {
+        best_score = score;
+        best = DIRECTIONS[d];
+      }
+    }
+  }
+  return best;
+}
+
+int Autopilot::playGame(SnakeGame& game, int max_moves) {
+  // Новая партия из любого состояния, как по Start в IdleState
+  game.start();
+  game.changeState<PlayingState>();
+
+  int moves = 0;
+  bool moved = true;
+  while (moved && !game.isOver() && moves < max_moves) {
+    game.processInput(decide(game));
+    std::uint64_t version = game.getFieldVersion();
+    for (int i = 0; i < MAX_UPDATES_PER_MOVE &&
+                    game.getFieldVersion() == version && !game.isOver();
+         ++i) {
+      game.update();
+    }
+    moved = game.getFieldVersion() != version || game.isOver();
+    ++moves;
+  }
+  return moves;
+}
+
+int Autopilot::cellIndex(const Point& point) {
+  if (point.x < 0 || point.x >= Field::WIDTH || point.y < 0 ||
+      point.y >= Field::HEIGHT) {
+    return NO_CELL;
+  }
+  return point.y * Field::WIDTH + point.x;
+}
+
+void Autopilot::prepare(const Snake& snake) {
+  free_at_.fill(0);
+  const auto& body = snake.getBody();
+  int length = static_cast<int>(body.size());
+  for (int i = 0; i < length; ++i) {
+    int index = cellIndex(body[i]);
+    if (index != NO_CELL) {
+      free_at_[index] = static_cast<std::int16_t>(length - i);
+    }
+  }
+}
+
+int Autopilot::findPath(int head, int target) {
+  // Сегмент тела с номером i от головы освобождается через length - i
+  // ходов, поэтому клетка проходима, если змейка доберется до нее не раньше
+  dist_.fill(NO_CELL);
+  dist_[head] = 0;
+  int queue_head = 0;
+  int queue_tail = 0;
+  queue_[queue_tail++] = static_cast<std::uint8_t>(head);
+  int result = NO_CELL;
+
+  while (queue_head < queue_tail && result == NO_CELL) {
+    int cell = queue_[queue_head++];
+    int x = cell % Field::WIDTH;
+    int y = cell / Field::WIDTH;
+    int next_dist = dist_[cell] + 1;
+    for (int d = 0; d < 4 && result == NO_CELL; ++d) {
+      int next = cellIndex(Point(x + DX[d], y + DY[d]));
+      if (next != NO_CELL && dist_[next] == NO_CELL &&
+          free_at_[next] <= next_dist) {
+        dist_[next] = static_cast<std::int16_t>(next_dist);
+        came_from_[next] = static_cast<std::int16_t>(cell);
+        queue_[queue_tail++] = static_cast<std::uint8_t>(next);
+        if (next == target) result = next_dist;
+      }
+    }
+  }
+  return result;
+}
+
+Autopilot::FillResult Autopilot::simulate(const Snake& snake, int steps,
+                                          bool grow) {
+  // Тело после steps ходов по path_: пройденные клетки от новой головы,
+  // затем начало прежнего тела
+  const auto& body = snake.getBody();
+  int length = static_cast<int>(body.size()) + (grow ? 1 : 0);
+  blocked_.reset();
+  int tail = NO_CELL;
+  for (int k = 0; k < length; ++k) {
+    int cell = k < steps ? path_[steps - 1 - k] : cellIndex(body[k - steps]);
+    if (k + 1 < length) {
+      blocked_.set(cell);
+    } else {
+      tail = cell;
+    }
+  }
+
+  // Заливка от новой головы по свободным клеткам
+  FillResult result;
+  visited_.reset();
+  int head = path_[steps - 1];
+  visited_.set(head);
+  int queue_head = 0;
+  int queue_tail = 0;
+  queue_[queue_tail++] = static_cast<std::uint8_t>(head);
+  while (queue_head < queue_tail) {
+    int cell = queue_[queue_head++];
+    int x = cell % Field::WIDTH;
+    int y = cell / Field::WIDTH;
+    for (int d = 0; d < 4; ++d) {
+      int next = cellIndex(Point(x + DX[d], y + DY[d]));
+      if (next != NO_CELL && !visited_.test(next) && !blocked_.test(next)) {
+        visited_.set(next);
+        queue_[queue_tail++] = static_cast<std::uint8_t>(next);
+        result.tail_reachable |= next == tail;
+        ++result.area;
+      }
+    }
+  }
+  return result;
+}
+
+}  // namespace s21
@@ -0,0 +1,60 @@
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+
+#include "../common.h"
+#include "field.h"
+#include "point.h"
+#include "snake.h"
+
+namespace s21 {
+
+class SnakeGame;
+
+// Автопилот змейки: кратчайший путь к яблоку поиском в ширину с проверкой,
+// что после его съедения голова еще может добраться до хвоста. Если такого
+// пути нет, змейка выбирает ход, после которого хвост достижим и свободного
+// места больше всего. Все рабочие буферы принадлежат объекту, поэтому
+// решение не выделяет память.
+class Autopilot {
+ public:
+  // Действие (Up/Down/Left/Right) для следующего хода змейки
+  UserAction_t decide(const SnakeGame& game);
+  Snake::Direction chooseDirection(const Snake& snake, const Point& apple);
+
+  // Начинает новую партию и играет ее без фронтенда до конца или до
+  // max_moves ходов. Возвращает количество сделанных ходов.
+  int playGame(SnakeGame& game, int max_moves);
+
+ private:
+  static constexpr int NO_CELL = -1;
+
+  struct FillResult {
+    int area{0};
+    bool tail_reachable{false};
+  };
+
+  static int cellIndex(const Point& point);
+  void prepare(const Snake& snake);
+  int findPath(int head, int target);
+  FillResult simulate(const Snake& snake, int steps, bool grow);
+
+  // Через сколько ходов клетка освободится от тела (0 - свободна)
+  std::array<std::int16_t, Field::CELLS> free_at_{};
+  std::array<std::int16_t, Field::CELLS> dist_{};
+  std::array<std::int16_t, Field::CELLS> came_from_{};
+  std::array<std::uint8_t, Field::CELLS> queue_{};
+  std::array<std::uint8_t, Field::CELLS> path_{};
+  std::bitset<Field::CELLS> blocked_;
+  std::bitset<Field::CELLS> visited_;
+  // С какого направления начинать перебор запасных ходов. Сдвигается при
+  // каждом вызове, чтобы змейка не ходила по одному и тому же кругу
+  int fallback_turn_{0};
+};
+
+}  // namespace s21
+
+#endif  // AUTOPILOT_H
@@ -12,8 +12,16 @@ Field::CellType Field::getCell(int x, int y) const {
 }
 
 void Field::setCell(int x, int y, CellType type) {
-  if (x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT) {  // LCOV_EXCL_LINE
+  if (x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT &&  // LCOV_EXCL_LINE
+      grid_[y][x] != type) {
+    if (grid_[y][x] == EMPTY) {
+      removeFree(y * WIDTH + x);
+    } else if (type == EMPTY) {
+      addFree(y * WIDTH + x);
+    }
     grid_[y][x] = type;
+    markDirty(x, y);
+    ++version_;
   }
 }
 
@@ -21,6 +29,43 @@ void Field::clear() {
   for (auto& row : grid_) {
     row.fill(EMPTY);
   }
+  for (int i = 0; i < CELLS; ++i) {
+    free_cells_[i] = static_cast<std::uint8_t>(i);
+    free_pos_[i] = static_cast<std::uint8_t>(i);
+  }
+  free_count_ = CELLS;
+  fully_dirty_ = true;
+  ++version_;
+  dirty_count_ = 0;
+}
+
+void Field::clearDirty() const {
+  fully_dirty_ = false;
+  dirty_count_ = 0;
+}
+
+void Field::markDirty(int x, int y) {
+  if (fully_dirty_) return;
+  if (dirty_count_ == DIRTY_CAPACITY) {
+    fully_dirty_ = true;
+    dirty_count_ = 0;
+  } else {
+    dirty_[dirty_count_++] = Point(x, y);
+  }
+}
+
+void Field::addFree(int index) {
+  free_cells_[free_count_] = static_cast<std::uint8_t>(index);
+  free_pos_[index] = static_cast<std::uint8_t>(free_count_);
+  ++free_count_;
+}
+
+void Field::removeFree(int index) {
+  int pos = free_pos_[index];
+  int last = free_cells_[--free_count_];
+  free_cells_[pos] = static_cast<std::uint8_t>(last);
+  free_pos_[last] = static_cast<std::uint8_t>(pos);
+  free_pos_[index] = NOT_FREE;
 }
 
 bool Field::isInside(const Point& point) const {
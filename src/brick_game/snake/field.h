@@ -2,6 +2,8 @@
 #define FIELD_H
 
 #include <array>
+#include <cstdint>
+#include <span>
 
 #include "point.h"
 
@@ -11,6 +13,9 @@ class Field {
  public:
   static constexpr int WIDTH = 10;
   static constexpr int HEIGHT = 20;
+  static constexpr int CELLS = WIDTH * HEIGHT;
+  // За ход змейки меняется не больше трех клеток: голова, хвост и яблоко
+  static constexpr int DIRTY_CAPACITY = 8;
 
   enum CellType { EMPTY = 0, SNAKE = 1, APPLE = 2, WALL = 3 };
 
@@ -27,8 +32,44 @@ class Field {
     return grid_;
   }
 
+  // Клетки, изменившиеся с последнего clearDirty(). Если список переполнен
+  // или поле очищалось целиком, isFullyDirty() возвращает true и
+  // перерисовывать нужно все поле. Список читает снимок поля в
+  // SnakeGame::makeGameInfo(); сброс не меняет клеток, поэтому он const.
+  std::span<const Point> getDirtyCells() const {
+    return {dirty_.data(), static_cast<size_t>(dirty_count_)};
+  }
+  bool isFullyDirty() const { return fully_dirty_; }
+  void clearDirty() const;
+
+  // Счетчик изменений: растет при каждом изменении клетки и очистке поля
+  std::uint64_t getVersion() const { return version_; }
+
+  // Индекс свободных (EMPTY) клеток, поддерживаемый в setCell()
+  int getFreeCount() const { return free_count_; }
+  Point getFreeCell(int i) const {
+    return Point(free_cells_[i] % WIDTH, free_cells_[i] / WIDTH);
+  }
+
  private:
+  static constexpr std::uint8_t NOT_FREE = 0xFF;
+  static_assert(CELLS < NOT_FREE, "cell index must fit in uint8_t");
+
+  void markDirty(int x, int y);
+  void addFree(int index);
+  void removeFree(int index);
+
   std::array<std::array<CellType, WIDTH>, HEIGHT> grid_{};
+  mutable std::array<Point, DIRTY_CAPACITY> dirty_{};
+  mutable int dirty_count_{0};
+  mutable bool fully_dirty_{true};
+  std::uint64_t version_{0};
+
+  // Плотный массив номеров свободных клеток и позиция каждой клетки в нем;
+  // удаление переставляет на место удаленной последний элемент
+  std::array<std::uint8_t, CELLS> free_cells_{};
+  std::array<std::uint8_t, CELLS> free_pos_{};
+  int free_count_{0};
 };
 
 }  // namespace s21
@@ -10,9 +10,9 @@ void Snake::initialize(const Point& start_pos) {
   direction_ = Direction::RIGHT;
   next_direction_ = Direction::RIGHT;
 
-  // Создаем начальную змейку (голова + 3 сегмента тела)
-  for (int i = 0; i < 4; ++i) {
-    body_.push_back(Point(start_pos.x - i, start_pos.y));
+  // Создаем начальную змейку (голова + 3 сегмента тела), начиная с хвоста
+  for (int i = 3; i >= 0; --i) {
+    pushFront(Point(start_pos.x - i, start_pos.y));
   }
 }
 
@@ -33,14 +33,15 @@ bool Snake::move(bool grow) {
     return false;  // Столкновение с собой
   }
 
-  // Добавляем новую голову
-  body_.push_front(new_head);
-
-  // Если не растем, удаляем хвост
+  // Если не растем, удаляем хвост. Делаем это до добавления головы: голова
+  // может занять только что освободившуюся клетку хвоста
   if (!grow) {
-    body_.pop_back();
+    popBack();
   }
 
+  // Добавляем новую голову
+  pushFront(new_head);
+
   return true;
 }
 
@@ -49,10 +50,36 @@ bool Snake::checkWallCollision(const Field& field) const {
 }
 
 bool Snake::contains(const Point& point) const {
-  return std::find(body_.begin(), body_.end() - 1, point) != body_.end() - 1;
+  // Хвост не учитывается: на следующем ходу он освободит клетку
+  int index = cellIndex(point);
+  return index >= 0 && occupied_.test(index) && point != body_.back();
+}
+
+void Snake::clear() {
+  body_.clear();
+  occupied_.reset();
 }
 
-void Snake::clear() { body_.clear(); }
+void Snake::pushFront(const Point& point) {
+  body_.pushFront(point);
+  int index = cellIndex(point);
+  if (index >= 0) occupied_.set(index);
+}
+
+void Snake::popBack() {
+  int index = cellIndex(body_.back());
+  if (index >= 0) occupied_.reset(index);
+  body_.popBack();
+}
+
+int Snake::cellIndex(const Point& point) {
+  // Клетки за пределами поля не отслеживаются
+  if (point.x < 0 || point.x >= Field::WIDTH || point.y < 0 ||
+      point.y >= Field::HEIGHT) {
+    return -1;
+  }
+  return point.y * Field::WIDTH + point.x;
+}
 
 Point Snake::getDirectionVector(Direction dir) const {
   switch (dir) {
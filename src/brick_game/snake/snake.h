@@ -1,12 +1,11 @@
 #ifndef SNAKE_H
 #define SNAKE_H
 
-#include <algorithm>
-#include <deque>
-#include <vector>
+#include <bitset>
 
 #include "field.h"
 #include "point.h"
+#include "snake_body.h"
 
 namespace s21 {
 
@@ -18,9 +17,9 @@ class Snake {
 
   void setDirection(Direction dir);
 
-  const std::deque<Point>& getBody() const { return body_; }
+  const SnakeBody& getBody() const { return body_; }
   Direction getNextDirection() const { return next_direction_; }
-  const Point& getHead() const { return body_.front(); }
+  Point getHead() const { return body_.front(); }
   size_t getLength() const { return body_.size(); }
   Point getDirectionVector(Direction dir) const;
 
@@ -32,7 +31,13 @@ class Snake {
   void clear();
 
  private:
-  std::deque<Point> body_;
+  void pushFront(const Point& point);
+  void popBack();
+  static int cellIndex(const Point& point);
+
+  SnakeBody body_;
+  // Занятые телом клетки поля, чтобы contains() работал за O(1)
+  std::bitset<Field::WIDTH * Field::HEIGHT> occupied_;
   Direction direction_;
   Direction next_direction_;
 };
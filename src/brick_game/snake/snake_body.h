@@ -0,0 +1,93 @@
+#ifndef SNAKE_BODY_H
+#define SNAKE_BODY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#include "field.h"
+#include "point.h"
+
+namespace s21 {
+
+// Тело змейки: кольцевой буфер фиксированного размера без выделений памяти.
+// Каждый сегмент упакован в 16 бит (x и y как знаковые байты), поэтому
+// сегменты за пределами поля (голова после удара о стену) тоже хранятся.
+class SnakeBody {
+ public:
+  // Степень двойки, не меньше числа клеток поля: индекс берется по маске
+  static constexpr int CAPACITY = 256;
+  static_assert((CAPACITY & (CAPACITY - 1)) == 0, "power of two required");
+  static_assert(CAPACITY >= Field::CELLS, "body must fit the whole field");
+
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Point;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = Point;
+
+    Iterator() = default;
+    Iterator(const SnakeBody* body, int index) : body_(body), index_(index) {}
+
+    Point operator*() const { return (*body_)[index_]; }
+    Iterator& operator++() {
+      ++index_;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator tmp = *this;
+      ++index_;
+      return tmp;
+    }
+    bool operator==(const Iterator& other) const {
+      return index_ == other.index_;
+    }
+
+   private:
+    const SnakeBody* body_{nullptr};
+    int index_{0};
+  };
+
+  Point operator[](int i) const { return unpack(cells_[(head_ + i) & MASK]); }
+  Point front() const { return (*this)[0]; }
+  Point back() const { return (*this)[size_ - 1]; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  Iterator begin() const { return Iterator(this, 0); }
+  Iterator end() const { return Iterator(this, size_); }
+
+  void pushFront(const Point& point) {
+    head_ = (head_ - 1) & MASK;
+    cells_[head_] = pack(point);
+    if (size_ < CAPACITY) ++size_;
+  }
+  void popBack() { --size_; }
+  void clear() {
+    head_ = 0;
+    size_ = 0;
+  }
+
+ private:
+  static constexpr int MASK = CAPACITY - 1;
+
+  static std::uint16_t pack(const Point& point) {
+    return static_cast<std::uint16_t>(static_cast<std::uint8_t>(point.x) |
+                                      static_cast<std::uint8_t>(point.y) << 8);
+  }
+  static Point unpack(std::uint16_t cell) {
+    return Point(static_cast<std::int8_t>(cell & 0xFF),
+                 static_cast<std::int8_t>(cell >> 8));
+  }
+
+  std::array<std::uint16_t, CAPACITY> cells_{};
+  int head_{0};
+  int size_{0};
+};
+
+}  // namespace s21
+
+#endif  // SNAKE_BODY_H
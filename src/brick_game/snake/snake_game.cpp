@@ -1,22 +1,115 @@
 #include "snake_game.h"
 
+#include "states/game_over_state.h"
 #include "states/idle_state.h"
 
 namespace s21 {
 
-SnakeGame::SnakeGame() : state_(std::make_unique<IdleState>()) {
+SnakeGame::SnakeGame(bool persist)
+    : state_(std::make_unique<IdleState>()), persist_(persist) {
   loadHighScore();
   initializeGame();
 }
 
 void SnakeGame::processInput(UserAction_t action) {
+  if (replay_ != nullptr) {
+    replay_record(replay_, ticks_, action);
+  }
   state_->handleInput(*this, action);
 }
 
-void SnakeGame::update() { state_->update(*this); }
+void SnakeGame::update() {
+  LATENCY_BEGIN(Latency_update);
+  ++ticks_;
+  state_->update(*this);
+  LATENCY_END(Latency_update);
+}
 
 GameInfo_t SnakeGame::getGameInfo() const { return state_->getGameInfo(*this); }
 
+bool SnakeGame::isOver() const {
+  return dynamic_cast<const GameOverState*>(state_.get()) != nullptr;
+}
+
+GameInfo_t SnakeGame::makeGameInfo(int score, int level, int speed,
+                                   int pause) const {
+  if (snapshot_version_ != field_.getVersion()) {
+    const auto& grid = field_.getGrid();
+    if (field_.isFullyDirty()) {
+      for (int y = 0; y < Field::HEIGHT; ++y) {
+        for (int x = 0; x < Field::WIDTH; ++x) {
+          field_data_[y][x] = static_cast<int>(grid[y][x]);
+        }
+        field_rows_[y] = field_data_[y].data();
+      }
+    } else {
+      for (const Point& cell : field_.getDirtyCells()) {
+        field_data_[cell.y][cell.x] = static_cast<int>(grid[cell.y][cell.x]);
+      }
+    }
+    field_.clearDirty();
+    snapshot_version_ = field_.getVersion();
+  }
+
+  GameInfo_t info{};
+  info.field = field_rows_.data();
+  info.next = nullptr;
+  info.score = score;
+  info.high_score = high_score_;
+  info.level = level;
+  info.speed = speed;
+  info.pause = pause;
+  return info;
+}
+
+void SnakeGame::seed(std::uint64_t seed) {
+  seed_ = seed;
+  apple_.seed(seed);
+}
+
+void SnakeGame::record(Replay_t* replay) {
+  replay_init(replay, Replay_snake, seed_);
+  replay_ = replay;
+}
+
+void SnakeGame::stopRecording() {
+  if (replay_ != nullptr) {
+    GameInfo_t info = getGameInfo();
+    replay_finish(replay_, ticks_, &info);
+    replay_ = nullptr;
+  }
+}
+
+bool SnakeGame::playReplay(const Replay_t& replay, ReplayResult_t& result) {
+  result = ReplayResult_t{};
+  if (replay.game != Replay_snake) return false;
+
+  SnakeGame game;
+  game.seed(replay.seed);
+  ReplayCursor_t cursor;
+  long tick = 0;
+  UserAction_t action = Up;
+  replay_cursor(&cursor, &replay);
+  bool pending = replay_next(&cursor, &tick, &action);
+  while (game.ticks_ < replay.ticks || (pending && tick == game.ticks_)) {
+    // Несколько нажатий могут прийти между двумя обновлениями
+    if (pending && tick == game.ticks_) {
+      game.processInput(action);
+      pending = replay_next(&cursor, &tick, &action);
+    } else {
+      game.update();
+    }
+  }
+
+  GameInfo_t info = game.getGameInfo();
+  result.ticks = game.ticks_;
+  result.score = info.score;
+  result.board_hash = replay_board_hash(&info);
+  result.matches = result.score == replay.score &&
+                   result.board_hash == replay.board_hash && !pending;
+  return result.matches;
+}
+
 void SnakeGame::start() {
   reset();
 
@@ -24,20 +117,17 @@ void SnakeGame::start() {
   Point start_pos(Field::WIDTH / 2, Field::HEIGHT / 2);
   snake_.initialize(start_pos);
 
-  // Размещаем яблоко
-  apple_.spawn(field_, snake_);
-
   // Обновляем поле
   field_.clear();
 
   // Отражаем змейку на поле
   const auto& body = snake_.getBody();
-  // int segment_index = 0;
   for (const auto& segment : body) {
     field_.setCell(segment.x, segment.y, Field::SNAKE);
   }
 
-  // Отрисовываем яблоко
+  // Размещаем и отрисовываем яблоко
+  apple_.spawn(field_, snake_);
   const auto& apple_pos = apple_.getPosition();
   field_.setCell(apple_pos.x, apple_pos.y, Field::APPLE);
 }
@@ -79,19 +169,22 @@ void SnakeGame::updateHighScore() {
   }
 }
 
+void SnakeGame::finish() {
+  updateHighScore();
+  if (persist_) {
+    highscore_finish(Replay_snake, score_, level_, seed_);
+  }
+}
+
 void SnakeGame::saveHighScore() const {
-  std::ofstream file(HIGHSCORE_FILE, std::ios::binary);
-  if (file.is_open()) {  // LCOV_EXCL_LINE
-    file.write(reinterpret_cast<const char*>(&high_score_),
-               sizeof(high_score_));
+  // Запись в файл откладывается фоновому потоку highscore
+  if (persist_) {
+    highscore_submit(HIGHSCORE_FILE, high_score_);
   }
 }
 
 void SnakeGame::loadHighScore() {
-  std::ifstream file(HIGHSCORE_FILE, std::ios::binary);
-  if (file.is_open()) {
-    file.read(reinterpret_cast<char*>(&high_score_), sizeof(high_score_));
-  }
+  high_score_ = highscore_load(HIGHSCORE_FILE);
 }
 
 }  // namespace s21
\ No newline at end of file
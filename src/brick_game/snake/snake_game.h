@@ -1,10 +1,14 @@
 #ifndef SNAKE_GAME_H
 #define SNAKE_GAME_H
 
-#include <fstream>
+#include <array>
+#include <cstdint>
 #include <memory>
 
 #include "../common.h"
+#include "../highscore.h"
+#include "../latency.h"
+#include "../replay.h"
 #include "apple.h"
 #include "field.h"
 #include "game_state.h"
@@ -19,19 +23,39 @@ class SnakeGame {
   friend class GameState;
 
   static constexpr int MAX_SNAKE_LENGTH = 200;
+  static_assert(MAX_SNAKE_LENGTH <= SnakeBody::CAPACITY);
   static constexpr int POINTS_PER_APPLE = 1;
   static constexpr int POINTS_PER_LEVEL = 5;
   static constexpr int MAX_LEVEL = 10;
   static constexpr int INITIAL_SPEED = 5;
   static constexpr int SPEED_INCREMENT = 2;
 
-  SnakeGame();
+  // persist: сохранять рекорд и итоги партий в таблицу лучших. Включено
+  // только у партии игрока (snake_interface), а не у ботов, сервера и
+  // проверки записей
+  explicit SnakeGame(bool persist = false);
   ~SnakeGame() = default;
+  // Снимок поля хранит указатели на строки field_data_ этого же объекта,
+  // поэтому игра не копируется и не перемещается
+  SnakeGame(const SnakeGame&) = delete;
+  SnakeGame& operator=(const SnakeGame&) = delete;
+  SnakeGame(SnakeGame&&) = delete;
+  SnakeGame& operator=(SnakeGame&&) = delete;
 
   // API для C-интерфейса
   void processInput(UserAction_t action);
   void update();
   GameInfo_t getGameInfo() const;
+  // Партия закончена (GameOverState: проигрыш или победа)
+  bool isOver() const;
+
+  // Запись партии: зерно задается до первого шага, после record() каждый
+  // processInput() становится событием с номером шага - числом update()
+  void seed(std::uint64_t seed);
+  void record(Replay_t* replay);
+  void stopRecording();
+  // Воспроизводит запись змейки в новой игре без отрисовки и сверяет итог
+  static bool playReplay(const Replay_t& replay, ReplayResult_t& result);
 
   // LCOV_EXCL_START
   // Смена состояний
@@ -52,11 +76,20 @@ class SnakeGame {
   const Snake& getSnake() const { return snake_; }
   const Apple& getApple() const { return apple_; }
 
+  // Общий для всех состояний снимок поля. Если поле изменилось с прошлого
+  // вызова, в int переводятся только клетки из списка изменений поля (все
+  // поле - после очистки или переполнения списка). Указатели в GameInfo_t
+  // живут, пока жив объект игры.
+  GameInfo_t makeGameInfo(int score, int level, int speed, int pause) const;
+  std::uint64_t getFieldVersion() const { return field_.getVersion(); }
+
   void start();
   void reset();
   void addScore(int points);
   void updateLevel();
   void updateHighScore();
+  // Конец партии: рекорд и запись в таблицу лучших
+  void finish();
 
  private:
   void initializeGame();
@@ -69,11 +102,21 @@ class SnakeGame {
 
   std::unique_ptr<GameState> state_;
 
+  mutable std::array<std::array<int, Field::WIDTH>, Field::HEIGHT>
+      field_data_{};
+  mutable std::array<int*, Field::HEIGHT> field_rows_{};
+  mutable std::uint64_t snapshot_version_{UINT64_MAX};
+
   int score_{0};
   int high_score_{0};
   int level_{1};
   int speed_{INITIAL_SPEED};
 
+  std::uint64_t seed_{0};
+  long ticks_{0};
+  Replay_t* replay_{nullptr};
+  bool persist_{false};
+
   static constexpr const char* HIGHSCORE_FILE = "snake_highscore.dat";
 };
 
@@ -1,18 +1,24 @@
 #include "snake_game.h"
 
-static s21::SnakeGame game_instance;
+// Партия игрока - единственная, что сохраняет рекорды
+static s21::SnakeGame game_instance(true);
 
 extern "C" {
 
 GameInfo_t updateCurrentState() {
+  LATENCY_BEGIN(Latency_state);
   game_instance.update();
-  return game_instance.getGameInfo();
+  GameInfo_t info = game_instance.getGameInfo();
+  LATENCY_END(Latency_state);
+  return info;
 }
 
 void userInput(UserAction_t action, bool hold) {
+  LATENCY_BEGIN(Latency_input);
   if (!hold) {
     game_instance.processInput(action);
   }
+  LATENCY_END(Latency_input);
 }
 
 }  // extern "C"
\ No newline at end of file
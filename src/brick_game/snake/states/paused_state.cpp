@@ -15,28 +15,8 @@ void PausedState::update(SnakeGame& game) {
 }
 
 GameInfo_t PausedState::getGameInfo(const SnakeGame& game) const {
-  GameInfo_t info{};
-
-  static int* rows[Field::HEIGHT];
-  static int field_data[Field::HEIGHT][Field::WIDTH];
-
-  const auto& grid = game.getField().getGrid();
-  for (int y = 0; y < Field::HEIGHT; ++y) {
-    for (int x = 0; x < Field::WIDTH; ++x) {
-      field_data[y][x] = static_cast<int>(grid[y][x]);
-    }
-    rows[y] = field_data[y];
-  }
-
-  info.field = rows;
-  info.next = nullptr;
-  info.score = game.getScore();
-  info.high_score = game.getHighScore();
-  info.level = game.getLevel();
-  info.speed = game.getSpeed();
-  info.pause = 1;
-
-  return info;
+  return game.makeGameInfo(game.getScore(), game.getLevel(), game.getSpeed(),
+                           1);
 }
 
 }  // namespace s21
\ No newline at end of file
@@ -49,65 +49,47 @@ void PlayingState::update(SnakeGame& game) {
   Snake::Direction dir = snake.getNextDirection();
   bool should_grow = ((snake.getHead() + snake.getDirectionVector(dir)) ==
                       apple.getPosition());
+  Point old_tail = snake.getBody().back();
 
   // Двигаем змейку                   // Столкновение со стеной
   if (!snake.move(should_grow) || snake.checkWallCollision(field)) {
     game.changeState<GameOverState>(false);
-    game.updateHighScore();
+    game.finish();
     return;
   }
 
+  // Обновляем на поле только изменившиеся клетки: освободившийся хвост
+  // (голова могла сразу занять его место) и новую голову
+  if (!should_grow) {
+    field.setCell(old_tail.x, old_tail.y, Field::EMPTY);
+  }
+  Point head = snake.getHead();
+  field.setCell(head.x, head.y, Field::SNAKE);
+
   // если should_grow то Обрабатываем съедение яблока
   if (should_grow) {
     game.addScore(SnakeGame::POINTS_PER_APPLE);
     game.updateLevel();
-    apple.spawn(field, snake);
   }
 
   // Проверяем победу
   if (snake.getLength() >= SnakeGame::MAX_SNAKE_LENGTH) {
     game.changeState<GameOverState>(true);
-    game.updateHighScore();
+    game.finish();
     return;
   }
 
-  // Обновляем поле
-  field.clear();
-
-  // Отрисовываем змейку
-  const auto& body = snake.getBody();
-  for (const auto& segment : body) {
-    field.setCell(segment.x, segment.y, Field::SNAKE);
+  // Новое яблоко появляется только на свободной клетке
+  if (should_grow) {
+    apple.spawn(field, snake);
+    const auto& apple_pos = apple.getPosition();
+    field.setCell(apple_pos.x, apple_pos.y, Field::APPLE);
   }
-
-  // Отрисовываем яблоко
-  const auto& apple_pos = apple.getPosition();
-  field.setCell(apple_pos.x, apple_pos.y, Field::APPLE);
 }
 
 GameInfo_t PlayingState::getGameInfo(const SnakeGame& game) const {
-  GameInfo_t info{};
-
-  static int* rows[Field::HEIGHT];
-  static int field_data[Field::HEIGHT][Field::WIDTH];
-
-  const auto& grid = game.getField().getGrid();
-  for (int y = 0; y < Field::HEIGHT; ++y) {
-    for (int x = 0; x < Field::WIDTH; ++x) {
-      field_data[y][x] = static_cast<int>(grid[y][x]);
-    }
-    rows[y] = field_data[y];
-  }
-
-  info.field = rows;
-  info.next = nullptr;
-  info.score = game.getScore();
-  info.high_score = game.getHighScore();
-  info.level = game.getLevel();
-  info.speed = game.getLevel();
-  info.pause = 0;
-
-  return info;
+  return game.makeGameInfo(game.getScore(), game.getLevel(), game.getLevel(),
+                           0);
 }
 
 }  // namespace s21
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "tetris_autoplay.h"
+
+#include <string.h>
+
+#define BOT_LOST (-1e9)  ///< Оценка установки, после которой игра окончена
+
+/**
+ * @brief Общие данные одного поиска, разделяемые задачами пула.
+ */
+typedef struct {
+  const Game_intro *val;
+  Placement_t first[MAX_PLACEMENTS];  ///< Установки текущей фигуры
+  double first_value[MAX_PLACEMENTS];
+  int order[MAX_PLACEMENTS];  ///< Допустимые установки по убыванию оценки
+  int valid;
+  double beam_value[MAX_PLACEMENTS];  ///< Оценка после второго хода
+  long beam_nodes[MAX_PLACEMENTS];
+} BotSearch_t;
+
+/**
+ * @brief Строит нажатия, которые приводят фигуру из начальной позиции в
+ * установку: повороты, сдвиги и сброс.
+ * @return Количество действий или 0, если так в установку не попасть.
+ */
+static int straight_path(const uint16_t *field, Figure_t fig,
+                         const Placement_t *target, UserAction_t *actions) {
+  int count = 0;
+  int ok = check_figure(field, &fig);
+  for (int r = 0; r < target->rotation && ok; r++) {
+    rotate(&fig);
+    ok = check_figure(field, &fig);
+    actions[count++] = Action;
+  }
+  while (ok && fig.x != target->x) {
+    int dx = fig.x < target->x ? 1 : -1;
+    fig.x += dx;
+    ok = check_figure(field, &fig);
+    actions[count++] = dx > 0 ? Right : Left;
+  }
+  if (ok) {
+    fig.y = drop_row(field, &fig);
+  }
+  actions[count++] = Down;
+  return ok && fig.y == target->y ? count : 0;
+}
+
+static int reachable(const uint16_t *field, const Figure_t *fig,
+                     const Placement_t *target) {
+  UserAction_t actions[BOT_MAX_ACTIONS];
+  return !target->game_over && straight_path(field, *fig, target, actions);
+}
+
+double bot_evaluate(const uint16_t *field, int lines) {
+  int heights[FIELD_WIDTH] = {0};
+  uint16_t seen = 0;
+  int holes = 0;
+  for (int y = 0; y < FIELD_HEIGHT; y++) {
+    uint16_t row = field[y] & (uint16_t)~WALL_MASK;
+    holes += __builtin_popcount(seen & (uint16_t)~row);
+    uint16_t fresh = row & (uint16_t)~seen;
+    for (int x = 0; x < FIELD_WIDTH && fresh; x++) {
+      if (fresh & (1u << (x + ROW_SHIFT))) {
+        heights[x] = FIELD_HEIGHT - y;
+      }
+    }
+    seen |= row;
+  }
+
+  int aggregate = heights[0];
+  int bumpiness = 0;
+  for (int x = 1; x < FIELD_WIDTH; x++) {
+    aggregate += heights[x];
+    bumpiness += abs(heights[x] - heights[x - 1]);
+  }
+  return BOT_WEIGHT_HEIGHT * aggregate + BOT_WEIGHT_LINES * lines +
+         BOT_WEIGHT_HOLES * holes + BOT_WEIGHT_BUMPINESS * bumpiness;
+}
+
+/**
+ * @brief Задача пула: раскрывает элемент луча установками следующей фигуры.
+ *
+ * Одна задача - один элемент: перечисление установок стоит десятки
+ * микросекунд, а выдача задачи - один захват мьютекса, поэтому мелкие
+ * задачи ничего не теряют на накладных расходах, а перехвату есть что
+ * делить, когда элементов луча больше, чем потоков.
+ */
+static void expand_beam(void *arg, int index, int worker) {
+  (void)worker;
+  BotSearch_t *search = arg;
+  const Placement_t *first = &search->first[search->order[index]];
+
+  Game_intro next;
+  memcpy(next.field, first->field, sizeof(next.field));
+  next.fig = search->val->next_fig;
+
+  Placement_t second[MAX_PLACEMENTS];
+  int count = find_placements(&next, second, MAX_PLACEMENTS);
+  double best = BOT_LOST;
+  for (int i = 0; i < count; i++) {
+    if (reachable(next.field, &next.fig, &second[i])) {
+      double value =
+          bot_evaluate(second[i].field, first->lines + second[i].lines);
+      best = value > best ? value : best;
+    }
+  }
+  search->beam_value[index] = best;
+  search->beam_nodes[index] = count;
+}
+
+static void sort_by_value(BotSearch_t *search) {
+  // Вставками: установок немного, а порядок при равенстве сохраняется
+  for (int i = 1; i < search->valid; i++) {
+    int current = search->order[i];
+    int j = i;
+    while (j > 0 && search->first_value[search->order[j - 1]] <
+                        search->first_value[current]) {
+      search->order[j] = search->order[j - 1];
+      j--;
+    }
+    search->order[j] = current;
+  }
+}
+
+int bot_plan(const Game_intro *val, const BotOptions_t *opts, BotPlan_t *plan) {
+  BotSearch_t search = {.val = val};
+
+  int count = find_placements(val, search.first, MAX_PLACEMENTS);
+  for (int i = 0; i < count; i++) {
+    if (reachable(val->field, &val->fig, &search.first[i])) {
+      search.first_value[i] =
+          bot_evaluate(search.first[i].field, search.first[i].lines);
+      search.order[search.valid++] = i;
+    }
+  }
+  sort_by_value(&search);
+
+  int beam = opts->beam_width < search.valid ? opts->beam_width : search.valid;
+  pool_parallel_for(opts->pool, beam, expand_beam, &search);
+
+  // Сведение в порядке луча, чтобы результат не зависел от числа потоков
+  int best = -1;
+  plan->nodes = count;
+  for (int i = 0; i < beam; i++) {
+    plan->nodes += search.beam_nodes[i];
+    if (best < 0 || search.beam_value[i] > search.beam_value[best]) {
+      best = i;
+    }
+  }
+
+  if (best >= 0) {
+    plan->target = search.first[search.order[best]];
+    plan->value = search.beam_value[best];
+    plan->count =
+        straight_path(val->field, val->fig, &plan->target, plan->actions);
+  } else {
+    plan->value = BOT_LOST;
+    plan->count = 1;
+    plan->actions[0] = Down;
+  }
+  return best >= 0;
+}
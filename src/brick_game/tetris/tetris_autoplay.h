@@ -0,0 +1,71 @@
+#ifndef TETRIS_AUTOPLAY_H
+#define TETRIS_AUTOPLAY_H
+
+#include "tetris_placement.h"
+#include "thread_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BOT_MAX_ACTIONS 24  ///< Повороты, сдвиги и сброс для одной фигуры
+#define BOT_DEFAULT_BEAM 8  ///< Ширина луча по умолчанию
+
+/**
+ * Веса оценки поля: суммарная высота столбцов, снятые линии, дыры
+ * (пустые клетки под верхом столбца) и перепады высот соседних столбцов.
+ */
+#define BOT_WEIGHT_HEIGHT (-0.510066)
+#define BOT_WEIGHT_LINES 0.760666
+#define BOT_WEIGHT_HOLES (-0.35663)
+#define BOT_WEIGHT_BUMPINESS (-0.184483)
+
+/**
+ * @brief Параметры поиска.
+ */
+typedef struct {
+  int beam_width;      ///< Сколько лучших установок текущей фигуры раскрывать
+  ThreadPool_t *pool;  ///< Пул для раскрытия луча или NULL
+} BotOptions_t;
+
+/**
+ * @brief Результат поиска: выбранная установка и действия для userInput().
+ */
+typedef struct {
+  Placement_t target;  ///< Выбранная установка текущей фигуры
+  double value;        ///< Оценка лучшей пары (текущая, следующая фигура)
+  long nodes;          ///< Количество оцененных позиций
+  int count;           ///< Количество действий
+  UserAction_t actions[BOT_MAX_ACTIONS];  ///< Повороты, сдвиги и Down
+} BotPlan_t;
+
+/**
+ * @brief Оценивает поле после установки (больше - лучше).
+ * @param field Поле без падающей фигуры.
+ * @param lines Количество снятых линий.
+ */
+double bot_evaluate(const uint16_t *field, int lines);
+
+/**
+ * @brief Выбирает установку текущей фигуры лучевым поиском на два хода.
+ *
+ * Все установки текущей фигуры оцениваются по полю после них, beam_width
+ * лучших раскрываются установками следующей фигуры (next_fig), и итоговой
+ * считается лучшая оценка на втором ходу. Раскрытия луча выполняются
+ * параллельно в пуле. Рассматриваются только установки, достижимые
+ * поворотами и сдвигами на месте появления с последующим сбросом, поэтому
+ * план исполняется нажатиями без учета таймингов.
+ *
+ * @param val Состояние игры (поле, текущая и следующая фигура).
+ * @param opts Параметры поиска.
+ * @param plan Результат.
+ * @return 1, если найдена установка без проигрыша, 0 в противном случае
+ * (план тогда состоит из одного Down).
+ */
+int bot_plan(const Game_intro *val, const BotOptions_t *opts, BotPlan_t *plan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TETRIS_AUTOPLAY_H
@@ -1,36 +1,165 @@
 #include "tetris_lib.h"
 
-int del_full_line(Game_intro *val) {
-  Game_intro tmp = *val;
-  int exp = 0;
-  int bonus = 1;
+/**
+ * Форма 4x4 упакована в 16 бит: клетка строки i и столбца j - бит 4 * i + j.
+ * Поворот по часовой стрелке переносит клетку [3 - j][i] в [i][j].
+ */
+#define SHAPE_BIT(m, i, j) \
+  ((((m) >> (4 * (3 - (j)) + (i))) & 1) << (4 * (i) + (j)))
+#define SHAPE_ROTATED_ROW(m, i)                                  \
+  (SHAPE_BIT(m, i, 0) | SHAPE_BIT(m, i, 1) | SHAPE_BIT(m, i, 2) | \
+   SHAPE_BIT(m, i, 3))
+#define SHAPE_ROTATE(m)                                                 \
+  (SHAPE_ROTATED_ROW(m, 0) | SHAPE_ROTATED_ROW(m, 1) |                  \
+   SHAPE_ROTATED_ROW(m, 2) | SHAPE_ROTATED_ROW(m, 3))
+#define SHAPE_ROTATIONS(name, m)                                   \
+  name##_0 = (m), name##_1 = SHAPE_ROTATE(name##_0),               \
+  name##_2 = SHAPE_ROTATE(name##_1), name##_3 = SHAPE_ROTATE(name##_2)
+
+enum {
+  SHAPE_ROTATIONS(SHAPE_I, 0x0F00),
+  SHAPE_ROTATIONS(SHAPE_J, 0x0710),   // J-фигура
+  SHAPE_ROTATIONS(SHAPE_L, 0x0E80),   // обратный J
+  SHAPE_ROTATIONS(SHAPE_O, 0x0660),   // квадрат
+  SHAPE_ROTATIONS(SHAPE_T, 0x0E40),   // гребень
+  SHAPE_ROTATIONS(SHAPE_Z, 0x0C60),   // Z
+  SHAPE_ROTATIONS(SHAPE_S, 0x0360)    // обратный Z
+};
+
+#define SHAPE_ROW(m, i) (((m) >> (4 * (i))) & 0xF)
+#define SHAPE_COLUMNS(m) \
+  (SHAPE_ROW(m, 0) | SHAPE_ROW(m, 1) | SHAPE_ROW(m, 2) | SHAPE_ROW(m, 3))
+#define FIRST_BIT(b) ((b) & 1 ? 0 : (b) & 2 ? 1 : (b) & 4 ? 2 : 3)
+#define LAST_BIT(b) ((b) & 8 ? 3 : (b) & 4 ? 2 : (b) & 2 ? 1 : 0)
+#define SHAPE_FILLED_ROWS(m)                                       \
+  ((SHAPE_ROW(m, 0) != 0) | (SHAPE_ROW(m, 1) != 0) << 1 |          \
+   (SHAPE_ROW(m, 2) != 0) << 2 | (SHAPE_ROW(m, 3) != 0) << 3)
+#define SHAPE_CELL(m, i, j) (((m) >> (4 * (i) + (j))) & 1)
+#define COLUMN_FLOOR(m, j)                                     \
+  (SHAPE_CELL(m, 3, j)   ? 3                                    \
+   : SHAPE_CELL(m, 2, j) ? 2                                    \
+   : SHAPE_CELL(m, 1, j) ? 1                                    \
+   : SHAPE_CELL(m, 0, j) ? 0                                    \
+                         : -1)
+#define PIECE_SHAPE(m)                                                     \
+  {{SHAPE_ROW(m, 0), SHAPE_ROW(m, 1), SHAPE_ROW(m, 2), SHAPE_ROW(m, 3)}, \
+   FIRST_BIT(SHAPE_COLUMNS(m)),                                          \
+   LAST_BIT(SHAPE_COLUMNS(m)),                                           \
+   FIRST_BIT(SHAPE_FILLED_ROWS(m)),                                      \
+   LAST_BIT(SHAPE_FILLED_ROWS(m)),                                       \
+   {COLUMN_FLOOR(m, 0), COLUMN_FLOOR(m, 1), COLUMN_FLOOR(m, 2),          \
+    COLUMN_FLOOR(m, 3)}}
+#define PIECE_ROTATIONS(name)                                    \
+  {PIECE_SHAPE(name##_0), PIECE_SHAPE(name##_1), PIECE_SHAPE(name##_2), \
+   PIECE_SHAPE(name##_3)}
+
+const PieceShape_t PIECE_SHAPES[PIECE_COUNT][4] = {
+    PIECE_ROTATIONS(SHAPE_I), PIECE_ROTATIONS(SHAPE_J),
+    PIECE_ROTATIONS(SHAPE_L), PIECE_ROTATIONS(SHAPE_O),
+    PIECE_ROTATIONS(SHAPE_T), PIECE_ROTATIONS(SHAPE_Z),
+    PIECE_ROTATIONS(SHAPE_S)};
+
+/**
+ * @brief Шаг splitmix64: раскладывает зерно по всем битам состояния.
+ */
+static uint64_t splitmix64(uint64_t *x) {
+  uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+void rng_seed(TetrisRng_t *rng, uint64_t seed) {
+  uint64_t mixer = seed;
+  uint64_t state = splitmix64(&mixer);
+  rng->inc = splitmix64(&mixer) << 1 | 1u;
+  rng->state = 0;
+  rng_next(rng);
+  rng->state += state;
+  rng_next(rng);
+}
+
+uint32_t rng_next(TetrisRng_t *rng) {
+  uint64_t old = rng->state;
+  rng->state = old * 6364136223846793005ull + rng->inc;
+  uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+  uint32_t rot = (uint32_t)(old >> 59);
+  return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+uint32_t rng_bounded(TetrisRng_t *rng, uint32_t bound) {
+  // Старшие 32 бита произведения - результат; младшие меньше порога
+  // попадают в неполный последний интервал и отбрасываются
+  uint64_t product = (uint64_t)rng_next(rng) * bound;
+  uint32_t low = (uint32_t)product;
+  if (low < bound) {
+    uint32_t threshold = -bound % bound;
+    while (low < threshold) {
+      product = (uint64_t)rng_next(rng) * bound;
+      low = (uint32_t)product;
+    }
+  }
+  return (uint32_t)(product >> 32);
+}
 
-  int s = 19;
-  for (int y = 19; y >= 0 && s > 0; y--) {
-    int full = 1;
-    for (int x = 0; x < 10; x++) {
-      val->field[y][x] = tmp.field[s][x];
-      if (!val->field[y][x]) {
-        full = 0;
+int next_piece(Game_intro *val) {
+  int piece;
+  if (val->randomizer == Random_bag) {
+    if (val->bag_left == 0) {
+      for (int i = 0; i < PIECE_COUNT; i++) {
+        val->bag[i] = (uint8_t)i;
       }
+      val->bag_left = PIECE_COUNT;
     }
+    // Шаг Фишера-Йетса: случайная из оставшихся уходит в конец мешка
+    int last = val->bag_left - 1;
+    int pick = (int)rng_bounded(&val->rng, (uint32_t)val->bag_left);
+    piece = val->bag[pick];
+    val->bag[pick] = val->bag[last];
+    val->bag[last] = (uint8_t)piece;
+    val->bag_left--;
+  } else {
+    piece = (int)rng_bounded(&val->rng, PIECE_COUNT);
+  }
+  return piece;
+}
 
-    if (full) {
-      y++;
+uint32_t fig_row_mask(const Figure_t *fig, int i) {
+  uint32_t mask = fig->rows[i];
+  if (fig->x < -ROW_SHIFT || fig->x > FIELD_WIDTH + ROW_SHIFT - 1) {
+    // Все клетки фигуры гарантированно за стенкой
+    mask = mask ? FULL_ROW : 0;
+  } else {
+    mask <<= fig->x + ROW_SHIFT;
+  }
+  return mask;
+}
+
+int del_full_line(Game_intro *val) {
+  int exp = 0;
+  int bonus = 1;
+
+  int dst = FIELD_HEIGHT - 1;
+  for (int src = FIELD_HEIGHT - 1; src >= 0; src--) {
+    if ((val->field[src] | WALL_MASK) == FULL_ROW) {
       exp += bonus * 100;
       bonus *= 2;
+    } else {
+      val->field[dst--] = val->field[src];
     }
-    s--;
+  }
+  while (dst >= 0) {
+    val->field[dst--] = WALL_MASK;
   }
   return exp;
 }
 
 int endval(Game_intro *val) {
-  for (int i = 0; i < 4; i++) {
-    for (int j = 0; j < 4; j++) {
-      if (val->fig.field[i][j]) {
-        val->field[val->fig.y + i][val->fig.x + j] = 1;
-      }
+  const PieceShape_t *shape = &PIECE_SHAPES[val->fig.piece][val->fig.rotation];
+  for (int i = shape->top; i <= shape->bottom; i++) {
+    int y = val->fig.y + i;
+    if (y >= 0 && y < FIELD_HEIGHT) {
+      val->field[y] |= (uint16_t)fig_row_mask(&val->fig, i);
     }
   }
 
@@ -38,79 +167,125 @@ int endval(Game_intro *val) {
 }
 
 void rotate(Figure_t *fig) {
-  Figure_t tmp = *fig;
+  fig->rotation = (fig->rotation + 1) & 3;
+  const PieceShape_t *shape = &PIECE_SHAPES[fig->piece][fig->rotation];
   for (int i = 0; i < 4; i++) {
-    for (int j = 0; j < 4; j++) {
-      fig->field[i][j] = tmp.field[3 - j][i];
-    }
+    fig->rows[i] = shape->rows[i];
   }
 }
 
-int check(Game_intro val) {
-  int result = 1;
-  for (int i = 0; i < 4 && result; i++) {
-    for (int j = 0; j < 4 && result; j++) {
-      int is_out_of_bounds =
-          val.fig.y + i >= 20 || val.fig.x + j < 0 || val.fig.x + j >= 10;
-      int is_collision_with_field = val.field[val.fig.y + i][val.fig.x + j];
-      if (val.fig.field[i][j] &&
-          (is_collision_with_field || is_out_of_bounds)) {
-        result = 0;
+int check_figure(const uint16_t *field, const Figure_t *fig) {
+  // Стенки проверяются по ограничивающему прямоугольнику, после этого маски
+  // строк гарантированно лежат внутри поля и сдвигаются без переполнения
+  const PieceShape_t *shape = &PIECE_SHAPES[fig->piece][fig->rotation];
+  int result = fig->x + shape->left >= 0 && fig->x + shape->right < FIELD_WIDTH;
+  for (int i = shape->top; i <= shape->bottom && result; i++) {
+    int y = fig->y + i;
+    // Строки выше поля пустые, ниже поля - пол
+    uint16_t row = y < 0 ? 0 : y >= FIELD_HEIGHT ? FULL_ROW : field[y];
+    result = !((uint32_t)fig->rows[i] << (fig->x + ROW_SHIFT) & row);
+  }
+  return result;
+}
+
+void column_heights(const uint16_t *field, int *heights) {
+  for (int x = 0; x < FIELD_WIDTH; x++) {
+    heights[x] = 0;
+  }
+  // Сверху вниз: первая занятая клетка столбца задает его высоту
+  uint16_t seen = WALL_MASK;
+  for (int y = 0; y < FIELD_HEIGHT && seen != FULL_ROW; y++) {
+    uint16_t fresh = field[y] & (uint16_t)~seen;
+    for (int x = 0; x < FIELD_WIDTH && fresh; x++) {
+      if (fresh & (1u << (x + ROW_SHIFT))) {
+        heights[x] = FIELD_HEIGHT - y;
       }
     }
+    seen |= fresh;
   }
-  return result;
 }
 
-int check_y(Game_intro val) {
-  val.fig.y++;
-  return !check(val);
+int drop_row(const uint16_t *field, const Figure_t *fig) {
+  const PieceShape_t *shape = &PIECE_SHAPES[fig->piece][fig->rotation];
+  int heights[FIELD_WIDTH];
+  column_heights(field, heights);
+
+  int row = FIELD_HEIGHT;
+  int above = 1;
+  for (int j = shape->left; j <= shape->right; j++) {
+    if (shape->floor[j] >= 0) {
+      int top = FIELD_HEIGHT - heights[fig->x + j];
+      int land = top - 1 - shape->floor[j];
+      above = above && fig->y <= land;
+      row = land < row ? land : row;
+    }
+  }
+
+  if (!above) {
+    // Фигура под навесом: между ней и верхом столбца могут быть клетки
+    Figure_t below = *fig;
+    below.y++;
+    while (check_figure(field, &below)) {
+      below.y++;
+    }
+    row = below.y - 1;
+  }
+  return row;
 }
 
-int check_right(Game_intro val) {
-  val.fig.x++;
-  return check(val);
+int check(const Game_intro *val) {
+  return check_figure(val->field, &val->fig);
 }
 
-int check_left(Game_intro val) {
-  val.fig.x--;
-  return check(val);
+int check_y(const Game_intro *val) {
+  Figure_t fig = val->fig;
+  fig.y++;
+  return !check_figure(val->field, &fig);
 }
 
-int check_rotate(Game_intro val) {
-  rotate(&val.fig);
-  return check(val);
+int check_right(const Game_intro *val) {
+  Figure_t fig = val->fig;
+  fig.x++;
+  return check_figure(val->field, &fig);
 }
 
-void init_figure(Game_intro *val, int num) {
-  const int ALL_SHAPES[7][4][4] = {// I
-                                   {{0}, {0, 0, 0, 0}, {1, 1, 1, 1}, {0}},
-                                   // J-фигура
-                                   {{0}, {1, 0, 0, 0}, {1, 1, 1, 0}, {0}},
-                                   // обратный J
-                                   {{0}, {0, 0, 0, 1}, {0, 1, 1, 1}, {0}},
-                                   // квадрат
-                                   {{0}, {0, 1, 1, 0}, {0, 1, 1, 0}, {0}},
-                                   // гребень
-                                   {{0}, {0, 0, 1, 0}, {0, 1, 1, 1}, {0}},
-                                   // Z
-                                   {{0}, {0, 1, 1, 0}, {0, 0, 1, 1}, {0}},
-                                   // обратный Z
-                                   {{0}, {0, 1, 1, 0}, {1, 1, 0, 0}, {0}}};
+int check_left(const Game_intro *val) {
+  Figure_t fig = val->fig;
+  fig.x--;
+  return check_figure(val->field, &fig);
+}
 
+int check_rotate(const Game_intro *val) {
+  Figure_t fig = val->fig;
+  rotate(&fig);
+  return check_figure(val->field, &fig);
+}
+
+void init_figure(Game_intro *val, int num) {
+  const PieceShape_t *shape = &PIECE_SHAPES[num][0];
   for (int i = 0; i < 4; i++) {
-    for (int j = 0; j < 4; j++) {
-      val->next_fig.field[i][j] = ALL_SHAPES[num][i][j];
-    }
+    val->next_fig.rows[i] = shape->rows[i];
   }
+  val->next_fig.piece = (uint8_t)num;
+  val->next_fig.rotation = 0;
   val->next_fig.x = 4;
   val->next_fig.y = -2;
 }
 
 long long current_millis() {
-  struct timeval tv;
-  gettimeofday(&tv, NULL);
-  return (long long)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+long long clock_now(const TetrisClock_t *clock) {
+  return clock->kind == Clock_virtual ? clock->virtual_ms : current_millis();
+}
+
+void clock_tick(TetrisClock_t *clock) {
+  if (clock->kind == Clock_virtual) {
+    clock->virtual_ms += clock->tick_ms;
+  }
 }
 
 void move_fig(Game_intro *val, UserAction_t action) {
@@ -118,21 +293,23 @@ void move_fig(Game_intro *val, UserAction_t action) {
   if (action == Pause) {
     val->pause = !val->pause;
   } else if (action == Down && can_move) {
-    val->delay_ms = 0;
+    // Мгновенный сброс: фигура сразу опускается на строку приземления и
+    // фиксируется на этом же шаге
+    val->fig.y = drop_row(val->field, &val->fig);
     val->fall = 1;
-  } else if (action == Left && check_left(*val) && can_move) {
+  } else if (action == Left && check_left(val) && can_move) {
     val->fig.x--;
-  } else if (action == Right && check_right(*val) && can_move) {
+  } else if (action == Right && check_right(val) && can_move) {
     val->fig.x++;
-  } else if (action == Action && check_rotate(*val) && can_move) {
+  } else if (action == Action && check_rotate(val) && can_move) {
     rotate(&val->fig);
   }
 
-  if (check_y(*val)) {
+  if (check_y(val)) {
     val->status = Calc_score;
   }
 
-  long long now = current_millis();
+  long long now = clock_now(&val->clock);
   if (now - val->last_time >= val->delay_ms - (val->level * 20)) {
     val->last_time = now;
     if (!val->pause && val->status == Move_fig) {
@@ -142,31 +319,26 @@ void move_fig(Game_intro *val, UserAction_t action) {
 }
 
 void load_high_score(Game_intro *val) {
-  FILE *file = fopen("highscore.dat", "rb");
-  if (file) {
-    size_t read_count = fread(&val->high_score, sizeof(int), 1, file);
-    if (read_count != 1) {
-      val->high_score = 0;
-    }
-    fclose(file);
-  }
+  val->high_score = highscore_load(TETRIS_HIGHSCORE_FILE);
 }
 
 void start_init(Game_intro *val) {
   Game_intro null_val = {0};
+  null_val.clock = val->clock;
+  null_val.rng = val->rng;
+  null_val.randomizer = val->randomizer;
   *val = null_val;
+  for (int y = 0; y < FIELD_HEIGHT; y++) {
+    val->field[y] = WALL_MASK;
+  }
   val->level = 1;
-  init_figure(val, rand() % 7);
+  init_figure(val, next_piece(val));
   load_high_score(val);
   val->fig.y = 5;
 }
 
 void save_high_score(const Game_intro *val) {
-  FILE *file = fopen("highscore.dat", "wb");
-  if (file) {
-    fwrite(&val->score, sizeof(int), 1, file);
-    fclose(file);
-  }
+  highscore_submit(TETRIS_HIGHSCORE_FILE, val->score);
 }
 
 void calc_score(Game_intro *val) {
@@ -174,94 +346,366 @@ void calc_score(Game_intro *val) {
   val->level = val->score / 600;
   val->level = val->level > 10 ? 10 : val->level;
   if (val->score > val->high_score) {
-    save_high_score(val);
     val->high_score = val->score;
   }
 }
 
 void spawn(Game_intro *val) {
-  val->last_time = current_millis();
+  val->last_time = clock_now(&val->clock);
   val->delay_ms = 400;
   val->fall = 0;
   val->fig = val->next_fig;
-  init_figure(val, rand() % 7);
+  init_figure(val, next_piece(val));
 }
 
-Game_intro *core(UserAction_t action) {
-  static Game_intro val = {0};
+/**
+ * Состояние отдельной партии вместе с буферами, на которые указывает
+ * возвращаемый GameInfo_t.
+ */
+struct TetrisGame {
+  Game_intro val;
+  uint64_t seed;     ///< Зерно, заданное tetris_seed()
+  long steps;        ///< Выполнено шагов с создания партии
+  Replay_t *replay;  ///< Текущая запись или NULL
+  int persist;       ///< Сохранять рекорд и итог (tetris_set_persist)
+  int field_data[FIELD_HEIGHT][FIELD_WIDTH];
+  int next_data[4][4];
+  int *field_rows[FIELD_HEIGHT];
+  int *next_rows[4];
+};
+
+/**
+ * @brief Направляет строки GameInfo_t на буферы своего экземпляра.
+ */
+static void bind_buffers(TetrisGame *game) {
+  for (int i = 0; i < FIELD_HEIGHT; i++) {
+    game->field_rows[i] = game->field_data[i];
+  }
+  for (int i = 0; i < 4; i++) {
+    game->next_rows[i] = game->next_data[i];
+  }
+}
+
+static void tetris_init(TetrisGame *game) {
+  Game_intro null_val = {0};
+  game->val = null_val;
+  // Зерно по умолчанию: время и адрес, чтобы одновременно созданные
+  // партии различались
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  game->seed = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+  game->seed ^= (uint64_t)(uintptr_t)game;
+  rng_seed(&game->val.rng, game->seed);
+  game->steps = 0;
+  game->replay = NULL;
+  game->persist = 0;
+  bind_buffers(game);
+}
+
+static TetrisGame *default_game(void) {
+  static TetrisGame game;
+  static int initialized = 0;
+  if (!initialized) {
+    tetris_init(&game);
+    // Рекорды и таблицу лучших пишет только партия игрока
+    game.persist = 1;
+    initialized = 1;
+  }
+  return &game;
+}
+
+static void pack_figure(const Figure_t *fig, uint8_t *piece, uint8_t *rotation,
+                        int8_t *x, int8_t *y) {
+  *piece = fig->piece;
+  *rotation = fig->rotation;
+  *x = (int8_t)fig->x;
+  *y = (int8_t)fig->y;
+}
+
+static int unpack_figure(Figure_t *fig, uint8_t piece, uint8_t rotation,
+                         int8_t x, int8_t y) {
+  int result = piece < PIECE_COUNT && rotation < 4;
+  if (result) {
+    const PieceShape_t *shape = &PIECE_SHAPES[piece][rotation];
+    for (int i = 0; i < 4; i++) {
+      fig->rows[i] = shape->rows[i];
+    }
+    fig->piece = piece;
+    fig->rotation = rotation;
+    fig->x = x;
+    fig->y = y;
+  }
+  return result;
+}
+
+_Static_assert(sizeof(TetrisSnapshot_t) == 96, "snapshot layout has holes");
+
+void tetris_pack(const Game_intro *val, TetrisSnapshot_t *snap) {
+  TetrisSnapshot_t null_snap = {0};
+  *snap = null_snap;
+  snap->rng_state = val->rng.state;
+  snap->rng_inc = val->rng.inc;
+  snap->virtual_ms = val->clock.virtual_ms;
+  snap->last_time = val->last_time;
+  snap->score = val->score;
+  snap->high_score = val->high_score;
+  snap->delay_ms = (uint16_t)val->delay_ms;
+  snap->tick_ms = (uint16_t)val->clock.tick_ms;
+
+  // По 10 бит внутренней части строки подряд; 200 бит - ровно 25 байт
+  uint32_t bits = 0;
+  int count = 0;
+  int out = 0;
+  for (int y = 0; y < FIELD_HEIGHT; y++) {
+    bits |= (uint32_t)((val->field[y] >> ROW_SHIFT) & 0x3FF) << count;
+    count += FIELD_WIDTH;
+    while (count >= 8) {
+      snap->board[out++] = (uint8_t)bits;
+      bits >>= 8;
+      count -= 8;
+    }
+  }
+
+  pack_figure(&val->fig, &snap->fig_piece, &snap->fig_rotation, &snap->fig_x,
+              &snap->fig_y);
+  pack_figure(&val->next_fig, &snap->next_piece, &snap->next_rotation,
+              &snap->next_x, &snap->next_y);
+  snap->status = (uint8_t)val->status;
+  snap->level = (uint8_t)val->level;
+  int virtual_clock = val->clock.kind == Clock_virtual;
+  snap->flags = (val->pause ? SNAPSHOT_PAUSE : 0) |
+                (val->fall ? SNAPSHOT_FALL : 0) |
+                (virtual_clock ? SNAPSHOT_VIRTUAL_CLOCK : 0) |
+                (val->randomizer == Random_bag ? SNAPSHOT_BAG : 0);
+  snap->bag_left = (uint8_t)val->bag_left;
+  memcpy(snap->bag, val->bag, sizeof(snap->bag));
+  snap->version = SNAPSHOT_VERSION;
+}
 
-  if (val.status == Start_init && action == Start) {
-    start_init(&val);
-    val.status = Spawn;
+int tetris_unpack(const TetrisSnapshot_t *snap, Game_intro *val) {
+  Game_intro tmp = {0};
+  int result = snap->version == SNAPSHOT_VERSION &&
+               snap->status <= Game_over && snap->bag_left <= PIECE_COUNT &&
+               unpack_figure(&tmp.fig, snap->fig_piece, snap->fig_rotation,
+                             snap->fig_x, snap->fig_y) &&
+               unpack_figure(&tmp.next_fig, snap->next_piece,
+                             snap->next_rotation, snap->next_x, snap->next_y);
+  for (int i = 0; i < PIECE_COUNT && result; i++) {
+    result = snap->bag[i] < PIECE_COUNT;
   }
-  if (val.status == Spawn) {
-    spawn(&val);
-    val.status = Move_fig;
+  if (result) {
+    uint32_t bits = 0;
+    int count = 0;
+    int in = 0;
+    for (int y = 0; y < FIELD_HEIGHT; y++) {
+      while (count < FIELD_WIDTH) {
+        bits |= (uint32_t)snap->board[in++] << count;
+        count += 8;
+      }
+      tmp.field[y] = WALL_MASK | (uint16_t)((bits & 0x3FF) << ROW_SHIFT);
+      bits >>= FIELD_WIDTH;
+      count -= FIELD_WIDTH;
+    }
+
+    tmp.rng.state = snap->rng_state;
+    tmp.rng.inc = snap->rng_inc;
+    tmp.clock.kind =
+        snap->flags & SNAPSHOT_VIRTUAL_CLOCK ? Clock_virtual : Clock_monotonic;
+    tmp.clock.tick_ms = snap->tick_ms;
+    tmp.clock.virtual_ms = snap->virtual_ms;
+    tmp.last_time = snap->last_time;
+    tmp.score = snap->score;
+    tmp.high_score = snap->high_score;
+    tmp.level = snap->level;
+    tmp.delay_ms = snap->delay_ms;
+    tmp.pause = (snap->flags & SNAPSHOT_PAUSE) != 0;
+    tmp.fall = (snap->flags & SNAPSHOT_FALL) != 0;
+    tmp.status = snap->status;
+    tmp.randomizer = snap->flags & SNAPSHOT_BAG ? Random_bag : Random_uniform;
+    tmp.bag_left = snap->bag_left;
+    memcpy(tmp.bag, snap->bag, sizeof(tmp.bag));
+    *val = tmp;
   }
-  if (val.status == Move_fig) {
-    move_fig(&val, action);
+  return result;
+}
+
+void core_step(Game_intro *val, UserAction_t action) {
+  LATENCY_BEGIN(Latency_update);
+  clock_tick(&val->clock);
+  if (val->status == Start_init && action == Start) {
+    start_init(val);
+    val->status = Spawn;
+  }
+  if (val->status == Spawn) {
+    spawn(val);
+    val->status = Move_fig;
   }
-  if (val.status == Calc_score) {
-    calc_score(&val);
-    val.status = val.fig.y < 0 ? Game_over : Spawn;
+  if (val->status == Move_fig) {
+    move_fig(val, action);
   }
-  if (val.status == Game_over && action == Start) {
-    val.status = Start_init;
-    start_init(&val);
-    val.status = Spawn;
+  if (val->status == Calc_score) {
+    calc_score(val);
+    val->status = val->fig.y < 0 ? Game_over : Spawn;
   }
+  if (val->status == Game_over && action == Start) {
+    val->status = Start_init;
+    start_init(val);
+    val->status = Spawn;
+  }
+  LATENCY_END(Latency_update);
+}
 
-  return &val;
+TetrisGame *tetris_create(void) {
+  TetrisGame *game = malloc(sizeof(TetrisGame));
+  if (game) {
+    tetris_init(game);
+  }
+  return game;
 }
 
-void userInput(UserAction_t action, bool hold) {
-  core(action);
-  if (hold) {
+void tetris_destroy(TetrisGame *game) { free(game); }
+
+TetrisGame *tetris_fork(const TetrisGame *game) {
+  TetrisGame *fork = malloc(sizeof(TetrisGame));
+  if (fork) {
+    *fork = *game;
+    fork->replay = NULL;
+    fork->persist = 0;
+    bind_buffers(fork);
   }
+  return fork;
 }
 
-GameInfo_t updateCurrentState() {
-  Game_intro *tmp = core(Up);
-  GameInfo_t result = {0};
+void tetris_snapshot(const TetrisGame *game, TetrisSnapshot_t *snap) {
+  tetris_pack(&game->val, snap);
+}
 
-  static int game_field_data[20][10];
-  static int next_figure_data[4][4];
-  static int *field_rows[20];
-  static int *next_rows[4];
+int tetris_restore(TetrisGame *game, const TetrisSnapshot_t *snap) {
+  return tetris_unpack(snap, &game->val);
+}
 
-  static int pointers_initialized = 0;
-  if (!pointers_initialized) {
-    for (int i = 0; i < 20; i++) {
-      field_rows[i] = game_field_data[i];
+void tetris_step(TetrisGame *game, UserAction_t action) {
+  // Up в тетрисе ничего не делает, поэтому записываются только нажатия
+  if (game->replay && action != Up) {
+    replay_record(game->replay, game->steps, action);
+  }
+  game->steps++;
+  int was_over = game->val.status == Game_over;
+  int best = game->val.high_score;
+  core_step(&game->val, action);
+  if (game->persist && game->val.high_score > best) {
+    save_high_score(&game->val);
+  }
+  if (game->persist && !was_over && game->val.status == Game_over) {
+    highscore_finish(Replay_tetris, game->val.score, game->val.level,
+                     game->seed);
+  }
+}
+
+void tetris_set_persist(TetrisGame *game, int persist) {
+  game->persist = persist;
+}
+
+void tetris_set_clock(TetrisGame *game, ClockKind_t kind, int tick_ms) {
+  game->val.clock.kind = kind;
+  game->val.clock.tick_ms = tick_ms;
+}
+
+const Game_intro *tetris_state(const TetrisGame *game) { return &game->val; }
+
+void tetris_seed(TetrisGame *game, uint64_t seed) {
+  game->seed = seed;
+  rng_seed(&game->val.rng, seed);
+  game->val.bag_left = 0;
+}
+
+void tetris_set_randomizer(TetrisGame *game, Randomizer_t randomizer) {
+  game->val.randomizer = randomizer;
+  game->val.bag_left = 0;
+}
+
+void tetris_record(TetrisGame *game, Replay_t *replay) {
+  replay_init(replay, Replay_tetris, game->seed);
+  replay->tick_ms = game->val.clock.tick_ms;
+  replay->rules = game->val.randomizer;
+  game->replay = replay;
+}
+
+void tetris_record_stop(TetrisGame *game) {
+  if (game->replay) {
+    GameInfo_t info = tetris_query(game);
+    replay_finish(game->replay, game->steps, &info);
+    game->replay = NULL;
+  }
+}
+
+int tetris_play_replay(const Replay_t *replay, ReplayResult_t *result) {
+  ReplayResult_t null_result = {0};
+  *result = null_result;
+  TetrisGame *game = replay->game == Replay_tetris ? tetris_create() : NULL;
+  if (game) {
+    tetris_set_clock(game, Clock_virtual, replay->tick_ms);
+    tetris_set_randomizer(game, (Randomizer_t)replay->rules);
+    tetris_seed(game, replay->seed);
+
+    ReplayCursor_t cursor;
+    long tick = 0;
+    UserAction_t action = Up;
+    replay_cursor(&cursor, replay);
+    int pending = replay_next(&cursor, &tick, &action);
+    for (long step = 0; step < replay->ticks; step++) {
+      if (pending && tick == step) {
+        tetris_step(game, action);
+        pending = replay_next(&cursor, &tick, &action);
+      } else {
+        tetris_step(game, Up);
+      }
     }
-    for (int i = 0; i < 4; i++) {
-      next_rows[i] = next_figure_data[i];
+
+    GameInfo_t info = tetris_query(game);
+    result->ticks = game->steps;
+    result->score = info.score;
+    result->board_hash = replay_board_hash(&info);
+    result->matches = result->score == replay->score &&
+                      result->board_hash == replay->board_hash && !pending;
+    tetris_destroy(game);
+  }
+  return result->matches;
+}
+
+GameInfo_t tetris_query(TetrisGame *game) {
+  const Game_intro *tmp = &game->val;
+  GameInfo_t result = {0};
+
+  result.field = game->field_rows;
+  result.next = game->next_rows;
+
+  // Тень показывается только для падающей фигуры
+  int ghost_y = tmp->status == Move_fig ? drop_row(tmp->field, &tmp->fig)
+                                        : tmp->fig.y;
+  for (int i = 0; i < FIELD_HEIGHT; i++) {
+    uint32_t row = tmp->field[i];
+    uint32_t ghost = 0;
+    int fig_i = i - tmp->fig.y;
+    int ghost_i = i - ghost_y;
+    if (fig_i >= 0 && fig_i < 4) {
+      row |= fig_row_mask(&tmp->fig, fig_i);
+    }
+    if (ghost_y != tmp->fig.y && ghost_i >= 0 && ghost_i < 4) {
+      ghost = fig_row_mask(&tmp->fig, ghost_i) & ~row;
     }
-    pointers_initialized = 1;
-  }
-
-  result.field = field_rows;
-  result.next = next_rows;
-
-  for (int i = 0; i < 20; i++) {
-    for (int j = 0; j < 10; j++) {
-      int is_figure_here = 0;
-      if (i >= tmp->fig.y && i < tmp->fig.y + 4 && j >= tmp->fig.x &&
-          j < tmp->fig.x + 4) {
-        int fig_i = i - tmp->fig.y;
-        int fig_j = j - tmp->fig.x;
-        if (fig_i >= 0 && fig_i < 4 && fig_j >= 0 && fig_j < 4) {
-          is_figure_here = tmp->fig.field[fig_i][fig_j];
-        }
+    for (int j = 0; j < FIELD_WIDTH; j++) {
+      int cell = (row >> (j + ROW_SHIFT)) & 1u;
+      if ((ghost >> (j + ROW_SHIFT)) & 1u) {
+        cell = CELL_GHOST;
       }
-
-      game_field_data[i][j] = tmp->field[i][j] || is_figure_here;
+      game->field_data[i][j] = cell;
     }
   }
 
   for (int i = 0; i < 4; i++) {
     for (int j = 0; j < 4; j++) {
-      next_figure_data[i][j] = tmp->next_fig.field[i][j];
+      game->next_data[i][j] = (tmp->next_fig.rows[i] >> j) & 1u;
     }
   }
 
@@ -272,4 +716,26 @@ GameInfo_t updateCurrentState() {
   result.pause = tmp->pause;
 
   return result;
-}
\ No newline at end of file
+}
+
+Game_intro *core(UserAction_t action) {
+  TetrisGame *game = default_game();
+  tetris_step(game, action);
+  return &game->val;
+}
+
+void userInput(UserAction_t action, bool hold) {
+  LATENCY_BEGIN(Latency_input);
+  core(action);
+  if (hold) {
+  }
+  LATENCY_END(Latency_input);
+}
+
+GameInfo_t updateCurrentState() {
+  LATENCY_BEGIN(Latency_state);
+  core(Up);
+  GameInfo_t info = tetris_query(default_game());
+  LATENCY_END(Latency_state);
+  return info;
+}
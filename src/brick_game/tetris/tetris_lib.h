@@ -2,20 +2,66 @@
 #define TETRIS_LIB_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <sys/time.h>
+#include <string.h>
 #include <time.h>
 
 #include "../common.h"
+#include "../highscore.h"
+#include "../latency.h"
+#include "../replay.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FIELD_HEIGHT 20  ///< Высота игрового поля
+#define FIELD_WIDTH 10   ///< Ширина игрового поля
+#define TETRIS_HIGHSCORE_FILE "highscore.dat"  ///< Файл рекорда
+
+/**
+ * Строка поля хранится 16-битной маской: клетка x лежит в бите
+ * x + ROW_SHIFT, а три бита слева и справа всегда заняты стенками. Поэтому
+ * выход фигуры за боковую границу ловится тем же AND, что и столкновение.
+ */
+#define ROW_SHIFT 3
+#define WALL_MASK ((uint16_t)0xE007)  ///< Пустая строка (только стенки)
+#define FULL_ROW ((uint16_t)0xFFFF)   ///< Полностью заполненная строка
+
+#define PIECE_COUNT 7  ///< Количество видов фигур
+
+/**
+ * @brief Форма фигуры в одном повороте: маски строк 4x4 и ограничивающий
+ * прямоугольник занятых клеток (границы включительно).
+ */
+typedef struct {
+  uint16_t rows[4];  ///< Строки фигуры 4x4 (бит j - клетка в столбце j)
+  int8_t left;       ///< Первый занятый столбец
+  int8_t right;      ///< Последний занятый столбец
+  int8_t top;        ///< Первая занятая строка
+  int8_t bottom;     ///< Последняя занятая строка
+  int8_t floor[4];   ///< Нижняя занятая строка столбца (-1 - столбец пуст)
+} PieceShape_t;
+
+/**
+ * @brief Все фигуры во всех поворотах: PIECE_SHAPES[вид][поворот].
+ * Таблица вычисляется при компиляции, поворот по часовой стрелке - это
+ * переход к следующему столбцу таблицы.
+ */
+extern const PieceShape_t PIECE_SHAPES[PIECE_COUNT][4];
 
 /**
- * @brief Структура для описания фигуры в игре (4x4 поле и координаты x,y).
+ * @brief Структура для описания фигуры в игре (4 маски строк и координаты
+ * x,y).
  */
 typedef struct {
-  int field[4][4];  ///< Клетки фигуры (1 - занята, 0 - пусто)
-  int x;            ///< Позиция фигуры по горизонтали
-  int y;            ///< Позиция фигуры по вертикали
+  uint16_t rows[4];  ///< Строки фигуры 4x4 (бит j - клетка в столбце j)
+  uint8_t piece;     ///< Вид фигуры (строка PIECE_SHAPES)
+  uint8_t rotation;  ///< Поворот (столбец PIECE_SHAPES)
+  int x;             ///< Позиция фигуры по горизонтали
+  int y;             ///< Позиция фигуры по вертикали
 } Figure_t;
 
 /**
@@ -29,12 +75,46 @@ typedef enum {
   Game_over    ///< Игра окончена
 } Status_t;
 
+/**
+ * @brief Источник времени для гравитации.
+ */
+typedef enum {
+  Clock_monotonic,  ///< Реальное монотонное время (для интерфейсов)
+  Clock_virtual     ///< Виртуальное время, растет на tick_ms за каждый шаг
+} ClockKind_t;
+
+/**
+ * @brief Часы партии. Виртуальные часы не зависят от реального времени,
+ * поэтому безголовые прогоны идут с максимальной скоростью и повторяемы.
+ */
+typedef struct {
+  int kind;               ///< Вид часов (ClockKind_t)
+  int tick_ms;            ///< Длительность одного шага виртуальных часов
+  long long virtual_ms;   ///< Текущее виртуальное время
+} TetrisClock_t;
+
+/**
+ * @brief Генератор PCG32 партии: 64 бита состояния и нечетный шаг потока.
+ */
+typedef struct {
+  uint64_t state;  ///< Состояние
+  uint64_t inc;    ///< Шаг (номер потока), всегда нечетный
+} TetrisRng_t;
+
+/**
+ * @brief Способ выбора следующей фигуры.
+ */
+typedef enum {
+  Random_uniform,  ///< Каждая фигура независимо и равновероятно
+  Random_bag       ///< Перемешанный мешок из всех семи фигур
+} Randomizer_t;
+
 /**
  * @brief Основная структура состояния игры, включая игровое поле, текущую и
  * следующую фигуру, счет и прочее.
  */
 typedef struct {
-  int field[20][10];  ///< Игровое поле (20 строк на 10 колонок)
+  uint16_t field[FIELD_HEIGHT];  ///< Игровое поле (маска на каждую строку)
   Figure_t fig;       ///< Текущая фигура
   Figure_t next_fig;  ///< Следующая фигура
   int high_score;     ///< Рекорд
@@ -44,9 +124,98 @@ typedef struct {
   int delay_ms;  ///< Задержка между ходами в миллисекундах
   int fall;  ///< Флаг падения фигуры
   long long last_time;  ///< Метка времени последнего обновления
+  TetrisClock_t clock;  ///< Источник времени партии
   int status;  ///< Текущий статус игры (Status_t)
+  TetrisRng_t rng;            ///< Генератор фигур партии
+  int randomizer;             ///< Способ выбора фигур (Randomizer_t)
+  uint8_t bag[PIECE_COUNT];   ///< Фигуры, оставшиеся в мешке
+  int bag_left;               ///< Сколько фигур осталось в мешке
 } Game_intro;
 
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_BOARD_BYTES (FIELD_HEIGHT * FIELD_WIDTH / 8)
+
+/// Биты TetrisSnapshot_t::flags
+#define SNAPSHOT_PAUSE 0x1
+#define SNAPSHOT_FALL 0x2
+#define SNAPSHOT_VIRTUAL_CLOCK 0x4
+#define SNAPSHOT_BAG 0x8
+
+/**
+ * @brief Упакованное состояние партии: все, что нужно, чтобы продолжить
+ * игру с того же места, в 96 байтах без указателей. Поле хранится по 10
+ * бит на строку (клетка x строки y - бит 10 * y + x), стенки
+ * восстанавливаются при распаковке, фигуры - видом, поворотом и позицией.
+ * Поля расположены по убыванию размера, поэтому выравнивание не оставляет
+ * дыр, и снимок копируется обычным memcpy. Порядок байт - родной.
+ */
+typedef struct {
+  uint64_t rng_state;  ///< Генератор фигур
+  uint64_t rng_inc;
+  int64_t virtual_ms;  ///< Виртуальное время часов
+  int64_t last_time;   ///< Время последнего шага гравитации
+  int32_t score;
+  int32_t high_score;
+  uint16_t delay_ms;
+  uint16_t tick_ms;  ///< Шаг виртуальных часов
+  uint8_t board[SNAPSHOT_BOARD_BYTES];
+  uint8_t fig_piece;
+  uint8_t fig_rotation;
+  int8_t fig_x;
+  int8_t fig_y;
+  uint8_t next_piece;
+  uint8_t next_rotation;
+  int8_t next_x;
+  int8_t next_y;
+  uint8_t status;
+  uint8_t level;
+  uint8_t flags;  ///< SNAPSHOT_PAUSE | SNAPSHOT_FALL | ...
+  uint8_t bag_left;
+  uint8_t bag[PIECE_COUNT];
+  uint8_t version;      ///< SNAPSHOT_VERSION
+  uint8_t reserved[7];  ///< Нули
+} TetrisSnapshot_t;
+
+/**
+ * @brief Задает зерно генератора. Разные зерна дают и разные состояния, и
+ * разные потоки PCG32.
+ * @param rng Генератор.
+ * @param seed Зерно.
+ */
+void rng_seed(TetrisRng_t *rng, uint64_t seed);
+
+/**
+ * @brief Следующее 32-битное число генератора.
+ * @param rng Генератор.
+ * @return Псевдослучайное число.
+ */
+uint32_t rng_next(TetrisRng_t *rng);
+
+/**
+ * @brief Равномерное число от 0 до bound - 1 без смещения остатка (метод
+ * Лемира с отбраковкой).
+ * @param rng Генератор.
+ * @param bound Верхняя граница (больше 0).
+ * @return Псевдослучайное число меньше bound.
+ */
+uint32_t rng_bounded(TetrisRng_t *rng, uint32_t bound);
+
+/**
+ * @brief Выбирает вид следующей фигуры генератором партии.
+ * @param val Указатель на состояние игры.
+ * @return Номер фигуры (от 0 до 6).
+ */
+int next_piece(Game_intro *val);
+
+/**
+ * @brief Возвращает маску строки фигуры, сдвинутую в координаты поля.
+ * @param fig Фигура.
+ * @param i Номер строки фигуры (0..3).
+ * @return Маска в разрядах строки поля; биты старше 15 - выход за правую
+ * стенку.
+ */
+uint32_t fig_row_mask(const Figure_t *fig, int i);
+
 /**
  * @brief Удаляет полностью заполненные линии из игрового поля и возвращает
  * начисленные очки.
@@ -63,40 +232,69 @@ int del_full_line(Game_intro *val);
  */
 int endval(Game_intro *val);
 
+/**
+ * @brief Проверяет, помещается ли фигура на поле без столкновений.
+ * @param field Строки поля (FIELD_HEIGHT масок).
+ * @param fig Фигура в координатах поля.
+ * @return 1, если фигура размещена корректно, 0 в противном случае.
+ */
+int check_figure(const uint16_t *field, const Figure_t *fig);
+
+/**
+ * @brief Вычисляет высоты столбцов поля.
+ * @param field Строки поля (FIELD_HEIGHT масок).
+ * @param heights Массив FIELD_WIDTH высот: 0 - пустой столбец, FIELD_HEIGHT -
+ * столбец заполнен до верхней строки.
+ */
+void column_heights(const uint16_t *field, int *heights);
+
+/**
+ * @brief Находит строку, в которой фигура остановится при сбросе.
+ *
+ * Если фигура во всех своих столбцах выше их верхних клеток, строка
+ * приземления вычисляется сразу по высотам столбцов и нижним клеткам фигуры
+ * (PieceShape_t::floor). Фигура под навесом опускается построчно.
+ *
+ * @param field Строки поля (FIELD_HEIGHT масок).
+ * @param fig Фигура в допустимой позиции.
+ * @return Координата y фигуры после сброса.
+ */
+int drop_row(const uint16_t *field, const Figure_t *fig);
+
 /**
  * @brief Проверяет, можно ли разместить фигуру в текущей позиции.
- * @param val Состояние игры.
+ * @param val Указатель на состояние игры.
  * @return 1, если фигура размещена корректно, 0 в противном случае.
  */
-int check(Game_intro val);
+int check(const Game_intro *val);
 
 /**
  * @brief Проверяет, возможно ли сместить фигуру вниз.
- * @param val Состояние игры.
+ * @param val Указатель на состояние игры.
  * @return 1, если возможно, 0 если столкновение.
  */
-int check_y(Game_intro val);
+int check_y(const Game_intro *val);
 
 /**
  * @brief Проверяет, возможно ли сместить фигуру вправо.
- * @param val Состояние игры.
+ * @param val Указатель на состояние игры.
  * @return 1, если возможно, 0 если столкновение.
  */
-int check_right(Game_intro val);
+int check_right(const Game_intro *val);
 
 /**
  * @brief Проверяет, возможно ли сместить фигуру влево.
- * @param val Состояние игры.
+ * @param val Указатель на состояние игры.
  * @return 1, если возможно, 0 если столкновение.
  */
-int check_left(Game_intro val);
+int check_left(const Game_intro *val);
 
 /**
  * @brief Проверяет, возможно ли повернуть фигуру.
- * @param val Состояние игры.
+ * @param val Указатель на состояние игры.
  * @return 1, если поворот возможен, 0 если столкновение.
  */
-int check_rotate(Game_intro val);
+int check_rotate(const Game_intro *val);
 
 /**
  * @brief Инициализирует фигуру с заданным номером формы.
@@ -113,13 +311,14 @@ void init_figure(Game_intro *val, int num);
 void move_fig(Game_intro *val, UserAction_t action);
 
 /**
- * @brief Загружает рекорд из файла.
+ * @brief Загружает рекорд (файл читается только при первом вызове).
  * @param val Указатель на состояние игры.
  */
 void load_high_score(Game_intro *val);
 
 /**
- * @brief Поворачивает фигуру на 90 градусов.
+ * @brief Поворачивает фигуру на 90 градусов по часовой стрелке (выборка из
+ * PIECE_SHAPES).
  * @param fig Указатель на фигуру.
  */
 void rotate(Figure_t *fig);
@@ -131,13 +330,14 @@ void rotate(Figure_t *fig);
 void start_init(Game_intro *val);
 
 /**
- * @brief Сохраняет рекорд в файл.
+ * @brief Сохраняет рекорд; запись в файл выполняет фоновый поток.
  * @param val Указатель на состояние игры.
  */
 void save_high_score(const Game_intro *val);
 
 /**
- * @brief Рассчитывает счет после завершения линии.
+ * @brief Рассчитывает счет после завершения линии. Рекорд обновляется
+ * только в памяти, в файл его сохраняет tetris_step().
  * @param val Указатель на состояние игры.
  */
 void calc_score(Game_intro *val);
@@ -149,19 +349,181 @@ void calc_score(Game_intro *val);
 void spawn(Game_intro *val);
 
 /**
- * @brief Возвращает текущее время в миллисекундах.
+ * @brief Возвращает текущее монотонное время в миллисекундах.
  * @return Время в миллисекундах.
  */
 long long current_millis();
 
+/**
+ * @brief Возвращает время по часам партии.
+ * @param clock Часы партии.
+ * @return Время в миллисекундах.
+ */
+long long clock_now(const TetrisClock_t *clock);
+
+/**
+ * @brief Продвигает виртуальные часы на один шаг (реальные не меняются).
+ * @param clock Часы партии.
+ */
+void clock_tick(TetrisClock_t *clock);
+
+/**
+ * @brief Упаковывает состояние игры в снимок.
+ * @param val Указатель на состояние игры.
+ * @param snap Снимок.
+ */
+void tetris_pack(const Game_intro *val, TetrisSnapshot_t *snap);
+
+/**
+ * @brief Распаковывает снимок. Снимок с чужой версией или невозможными
+ * значениями (вид фигуры, статус, мешок) отвергается.
+ * @param snap Снимок.
+ * @param val Указатель на состояние игры (не меняется при ошибке).
+ * @return 1 при успехе, 0 если снимок поврежден.
+ */
+int tetris_unpack(const TetrisSnapshot_t *snap, Game_intro *val);
+
+/**
+ * @brief Выполняет один шаг конечного автомата для переданного состояния.
+ * @param val Указатель на состояние игры.
+ * @param action Действие пользователя.
+ */
+void core_step(Game_intro *val, UserAction_t action);
+
 /**
  * @brief Основная игровая функция, обрабатывающая состояние на основе действия
- * пользователя.
+ * пользователя. Работает с партией по умолчанию, которую используют
+ * userInput() и updateCurrentState().
  * @param action Действие пользователя.
  * @return Текущее состояние игры.
  */
 Game_intro *core(UserAction_t action);
 
+/**
+ * @brief Непрозрачный дескриптор отдельной партии. Все состояние хранится в
+ * экземпляре, поэтому в одном процессе может идти любое число партий.
+ */
+typedef struct TetrisGame TetrisGame;
+
+/**
+ * @brief Создает новую партию в состоянии Start_init.
+ * @return Дескриптор партии или NULL, если не хватило памяти.
+ */
+TetrisGame *tetris_create(void);
+
+/**
+ * @brief Освобождает партию.
+ * @param game Дескриптор партии (может быть NULL).
+ */
+void tetris_destroy(TetrisGame *game);
+
+/**
+ * @brief Выполняет один шаг партии.
+ * @param game Дескриптор партии.
+ * @param action Действие пользователя (Up - просто шаг без ввода).
+ */
+void tetris_step(TetrisGame *game, UserAction_t action);
+
+/**
+ * @brief Копирует партию вместе с генератором, часами и счетчиком шагов.
+ * Копия идет независимо от исходной и не пишет запись, поэтому годится для
+ * просмотра вперед.
+ * @param game Дескриптор партии.
+ * @return Новая партия или NULL, если не хватило памяти.
+ */
+TetrisGame *tetris_fork(const TetrisGame *game);
+
+/**
+ * @brief Снимает состояние партии.
+ * @param game Дескриптор партии.
+ * @param snap Снимок.
+ */
+void tetris_snapshot(const TetrisGame *game, TetrisSnapshot_t *snap);
+
+/**
+ * @brief Возвращает партию к снимку. Зерно, счетчик шагов и запись партии
+ * не меняются.
+ * @param game Дескриптор партии.
+ * @param snap Снимок.
+ * @return 1 при успехе, 0 если снимок поврежден.
+ */
+int tetris_restore(TetrisGame *game, const TetrisSnapshot_t *snap);
+
+/**
+ * @brief Возвращает состояние партии для отрисовки. Указатели field и next
+ * ссылаются на буферы экземпляра и действительны до следующего вызова
+ * tetris_query() или tetris_destroy().
+ * @param game Дескриптор партии.
+ * @return Текущее состояние игры.
+ */
+GameInfo_t tetris_query(TetrisGame *game);
+
+/**
+ * @brief Задает источник времени партии. Сохраняется между перезапусками.
+ * @param game Дескриптор партии.
+ * @param kind Вид часов (ClockKind_t).
+ * @param tick_ms Длительность шага виртуальных часов (для Clock_virtual).
+ */
+void tetris_set_clock(TetrisGame *game, ClockKind_t kind, int tick_ms);
+
+/**
+ * @brief Включает сохранение рекорда и итогов партии в таблицу лучших.
+ * Выключено у tetris_create(), tetris_fork() и проверки записей, чтобы
+ * боты, сервер и просмотр вперед не попадали в таблицу; включено только у
+ * партии userInput().
+ * @param game Дескриптор партии.
+ * @param persist 1 - сохранять, 0 - нет.
+ */
+void tetris_set_persist(TetrisGame *game, int persist);
+
+/**
+ * @brief Дает доступ к внутреннему состоянию партии только для чтения.
+ * @param game Дескриптор партии.
+ * @return Указатель на состояние игры.
+ */
+const Game_intro *tetris_state(const TetrisGame *game);
+
+/**
+ * @brief Задает зерно генератора фигур партии. Без него партия получает
+ * зерно из текущего времени. У каждой партии свой генератор, поэтому
+ * партии в разных потоках не мешают друг другу.
+ * @param game Дескриптор партии.
+ * @param seed Зерно.
+ */
+void tetris_seed(TetrisGame *game, uint64_t seed);
+
+/**
+ * @brief Задает способ выбора фигур. Сохраняется между перезапусками.
+ * @param game Дескриптор партии.
+ * @param randomizer Способ выбора (Randomizer_t).
+ */
+void tetris_set_randomizer(TetrisGame *game, Randomizer_t randomizer);
+
+/**
+ * @brief Начинает запись партии: replay получает зерно, способ выбора фигур
+ * и шаг часов партии, дальше каждый tetris_step() с действием, отличным от
+ * Up, становится событием. Вызывается для новой партии до первого шага;
+ * воспроизводимы только партии на виртуальных часах.
+ * @param game Дескриптор партии.
+ * @param replay Запись (принадлежит вызывающему).
+ */
+void tetris_record(TetrisGame *game, Replay_t *replay);
+
+/**
+ * @brief Заканчивает запись: сохраняет в replay число шагов, счет и хэш
+ * поля.
+ * @param game Дескриптор партии.
+ */
+void tetris_record_stop(TetrisGame *game);
+
+/**
+ * @brief Воспроизводит запись в новой партии без отрисовки и сверяет итог.
+ * @param replay Запись тетриса.
+ * @param result Итог воспроизведения.
+ * @return 1, если счет и поле совпали с записанными, 0 в противном случае.
+ */
+int tetris_play_replay(const Replay_t *replay, ReplayResult_t *result);
+
 /**
  * \mainpage Игра Тетрис
  * \section A Конечный автомат игры
@@ -191,4 +553,8 @@ Game_intro *core(UserAction_t action);
  * \enddot
  */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,145 @@
+#include "tetris_placement.h"
+
+#include <string.h>
+
+/**
+ * @brief Рабочие данные одного перечисления.
+ */
+typedef struct {
+  const Game_intro *val;
+  Figure_t rotations[4];  ///< Текущая фигура во всех поворотах
+  uint64_t visited[(PLACEMENT_STATES + 63) / 64];
+  uint16_t queue[PLACEMENT_STATES];
+  int head;
+  int tail;
+  Placement_t *out;
+  int count;
+  int max;
+} Search_t;
+
+static int state_index(int rotation, int x, int y) {
+  return (rotation * PLACEMENT_X_RANGE + (x - PLACEMENT_X_MIN)) *
+             PLACEMENT_Y_RANGE +
+         (y - PLACEMENT_Y_MIN);
+}
+
+static int in_range(int x, int y) {
+  return x >= PLACEMENT_X_MIN && x < PLACEMENT_X_MIN + PLACEMENT_X_RANGE &&
+         y >= PLACEMENT_Y_MIN && y < PLACEMENT_Y_MIN + PLACEMENT_Y_RANGE;
+}
+
+static Figure_t figure_at(const Search_t *search, int rotation, int x, int y) {
+  Figure_t fig = search->rotations[rotation];
+  fig.x = x;
+  fig.y = y;
+  return fig;
+}
+
+static int fits(const Search_t *search, int rotation, int x, int y) {
+  Figure_t fig = figure_at(search, rotation, x, y);
+  return in_range(x, y) && check_figure(search->val->field, &fig);
+}
+
+static void enqueue(Search_t *search, int rotation, int x, int y) {
+  int index = state_index(rotation, x, y);
+  uint64_t bit = 1ull << (index & 63);
+  if (!(search->visited[index >> 6] & bit)) {
+    search->visited[index >> 6] |= bit;
+    search->queue[search->tail++] = (uint16_t)index;
+  }
+}
+
+static uint32_t row_at(const Figure_t *fig, int y) {
+  int i = y - fig->y;
+  return i >= 0 && i < 4 ? fig_row_mask(fig, i) : 0;
+}
+
+static int same_cells(const Figure_t *a, const Figure_t *b) {
+  // Сравниваем клетки в координатах поля, а не маски внутри 4x4
+  int top = a->y < b->y ? a->y : b->y;
+  int same = 1;
+  for (int y = top; y < top + 8 && same; y++) {
+    same = row_at(a, y) == row_at(b, y);
+  }
+  return same;
+}
+
+static void emit(Search_t *search, int rotation, int x, int y) {
+  Figure_t fig = figure_at(search, rotation, x, y);
+  int duplicate = 0;
+  for (int i = 0; i < search->count && !duplicate; i++) {
+    duplicate = same_cells(&search->out[i].fig, &fig);
+  }
+  if (!duplicate && search->count < search->max) {
+    Placement_t *placement = &search->out[search->count++];
+    placement->rotation = rotation;
+    placement->x = x;
+    placement->y = y;
+    placement->fig = fig;
+    placement->game_over = y < 0;
+    placement->lines = 0;
+    for (int row = 0; row < FIELD_HEIGHT; row++) {
+      placement->field[row] =
+          search->val->field[row] | (uint16_t)row_at(&fig, row);
+      placement->lines += (placement->field[row] | WALL_MASK) == FULL_ROW;
+    }
+
+    Game_intro tmp;
+    memcpy(tmp.field, placement->field, sizeof(tmp.field));
+    placement->score = del_full_line(&tmp);
+    memcpy(placement->field, tmp.field, sizeof(placement->field));
+  }
+}
+
+int find_placements(const Game_intro *val, Placement_t *out, int max) {
+  static const int MOVES[3][2] = {{-1, 0}, {1, 0}, {0, 1}};  // dx, drotation
+  Search_t search;
+  memset(search.visited, 0, sizeof(search.visited));
+  search.val = val;
+  search.head = 0;
+  search.tail = 0;
+  search.out = out;
+  search.count = 0;
+  search.max = max;
+
+  search.rotations[0] = val->fig;
+  for (int r = 1; r < 4; r++) {
+    search.rotations[r] = search.rotations[r - 1];
+    rotate(&search.rotations[r]);
+  }
+
+  if (fits(&search, 0, val->fig.x, val->fig.y)) {
+    enqueue(&search, 0, val->fig.x, val->fig.y);
+  }
+
+  while (search.head < search.tail) {
+    int index = search.queue[search.head++];
+    int y = index % PLACEMENT_Y_RANGE + PLACEMENT_Y_MIN;
+    int x = index / PLACEMENT_Y_RANGE % PLACEMENT_X_RANGE + PLACEMENT_X_MIN;
+    int rotation = index / (PLACEMENT_Y_RANGE * PLACEMENT_X_RANGE);
+    int resting = !fits(&search, rotation, x, y + 1);
+
+    if (resting) {
+      emit(&search, rotation, x, y);
+    } else {
+      enqueue(&search, rotation, x, y + 1);
+    }
+
+    // Как в move_fig(), опора проверяется сразу после действия: фигура,
+    // легшая от сдвига или поворота, фиксируется и в очередь не попадает.
+    // Поэтому лежащая фигура в очереди всегда легла от падения, и только
+    // она успевает сделать еще одно действие.
+    for (int m = 0; m < 3; m++) {
+      int nx = x + MOVES[m][0];
+      int nr = (rotation + MOVES[m][1]) & 3;
+      if (fits(&search, nr, nx, y)) {
+        if (!fits(&search, nr, nx, y + 1)) {
+          emit(&search, nr, nx, y);
+        } else {
+          enqueue(&search, nr, nx, y);
+        }
+      }
+    }
+  }
+  return search.count;
+}
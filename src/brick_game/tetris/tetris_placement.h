@@ -0,0 +1,56 @@
+#ifndef TETRIS_PLACEMENT_H
+#define TETRIS_PLACEMENT_H
+
+#include "tetris_lib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MAX_PLACEMENTS 128  ///< Верхняя граница числа различных установок
+
+/**
+ * Пространство состояний фигуры: поворот, x от -3 до 12 и y от -4 до 19.
+ * Каждое состояние - один бит в битсете посещенных.
+ */
+#define PLACEMENT_X_MIN (-ROW_SHIFT)
+#define PLACEMENT_X_RANGE 16
+#define PLACEMENT_Y_MIN (-4)
+#define PLACEMENT_Y_RANGE (FIELD_HEIGHT + 4)
+#define PLACEMENT_STATES (4 * PLACEMENT_X_RANGE * PLACEMENT_Y_RANGE)
+
+/**
+ * @brief Итоговая установка фигуры и поле после нее.
+ */
+typedef struct {
+  int rotation;  ///< Число поворотов (Action) относительно текущей фигуры
+  int x;         ///< Позиция фигуры по горизонтали
+  int y;         ///< Строка, в которой фигура фиксируется
+  int score;     ///< Очки за снятые линии (как в del_full_line)
+  int lines;     ///< Количество снятых линий
+  int game_over;  ///< 1, если фиксация в этой позиции заканчивает игру
+  Figure_t fig;   ///< Фигура в итоговой позиции
+  uint16_t field[FIELD_HEIGHT];  ///< Поле после фиксации и снятия линий
+} Placement_t;
+
+/**
+ * @brief Перечисляет все достижимые итоговые установки текущей фигуры.
+ *
+ * Обход в ширину по состояниям (поворот, x, y) с теми же ходами, что и в
+ * move_fig(): влево, вправо, поворот и падение на строку. Как и в игре,
+ * фигура, легшая от падения, успевает сделать еще одно действие, а легшая
+ * от сдвига или поворота фиксируется сразу. Установки с одинаковым
+ * набором клеток возвращаются один раз.
+ *
+ * @param val Состояние игры (используются поле и текущая фигура).
+ * @param out Массив для результатов.
+ * @param max Размер массива out.
+ * @return Количество найденных установок (не больше max).
+ */
+int find_placements(const Game_intro *val, Placement_t *out, int max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TETRIS_PLACEMENT_H
@@ -0,0 +1,226 @@
+#include "thread_pool.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+/// Сколько раз простаивающий поток уступает процессор перед сном
+#define POOL_SPIN_YIELDS 64
+
+/**
+ * @brief Диапазон итераций, принадлежащий одному потоку.
+ */
+typedef struct {
+  pthread_mutex_t lock;
+  int begin;
+  int end;
+} WorkRange_t;
+
+/**
+ * @brief Аргумент потока: пул и номер потока в нем.
+ */
+typedef struct {
+  ThreadPool_t *pool;
+  int id;
+} Worker_t;
+
+struct ThreadPool {
+  int threads;
+  pthread_t *handles;  ///< Фоновые потоки 1..threads-1, поток 0 - вызывающий
+  Worker_t *workers;
+  WorkRange_t *ranges;
+
+  pthread_mutex_t lock;
+  pthread_cond_t start;    ///< Сигнал о новом задании
+  pthread_cond_t done;     ///< Сигнал о завершении задания
+  atomic_uint generation;  ///< Номер текущего задания
+  atomic_int active;       ///< Сколько фоновых потоков еще заняты заданием
+  atomic_int stop;         ///< Флаг завершения пула
+  PoolTask_t task;
+  void *arg;
+};
+
+static int take_own(WorkRange_t *range, int *index) {
+  int found = 0;
+  pthread_mutex_lock(&range->lock);
+  if (range->begin < range->end) {
+    *index = range->begin++;
+    found = 1;
+  }
+  pthread_mutex_unlock(&range->lock);
+  return found;
+}
+
+static int steal(ThreadPool_t *pool, int self, int *index) {
+  int found = 0;
+  for (int i = 1; i < pool->threads && !found; i++) {
+    WorkRange_t *victim = &pool->ranges[(self + i) % pool->threads];
+    int begin = 0;
+    int end = 0;
+    pthread_mutex_lock(&victim->lock);
+    if (victim->begin < victim->end) {
+      // Забираем вторую половину, владелец продолжает с начала
+      begin = victim->begin + (victim->end - victim->begin) / 2;
+      end = victim->end;
+      victim->end = begin;
+      found = 1;
+    }
+    pthread_mutex_unlock(&victim->lock);
+
+    if (found) {
+      WorkRange_t *own = &pool->ranges[self];
+      pthread_mutex_lock(&own->lock);
+      own->begin = begin + 1;
+      own->end = end;
+      pthread_mutex_unlock(&own->lock);
+      *index = begin;
+    }
+  }
+  return found;
+}
+
+static void run_ranges(ThreadPool_t *pool, int self) {
+  int index;
+  while (take_own(&pool->ranges[self], &index) ||
+         steal(pool, self, &index)) {
+    pool->task(pool->arg, index, self);
+  }
+}
+
+/**
+ * @brief Ждет нового задания или остановки. Задания в поиске идут часто и
+ * короткие, поэтому сначала поток недолго уступает процессор и только
+ * потом засыпает на условной переменной.
+ */
+static unsigned wait_generation(ThreadPool_t *pool, unsigned seen) {
+  for (int i = 0; i < POOL_SPIN_YIELDS &&
+                  atomic_load(&pool->generation) == seen &&
+                  !atomic_load(&pool->stop);
+       i++) {
+    sched_yield();
+  }
+  pthread_mutex_lock(&pool->lock);
+  while (atomic_load(&pool->generation) == seen && !atomic_load(&pool->stop)) {
+    pthread_cond_wait(&pool->start, &pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return atomic_load(&pool->generation);
+}
+
+static void *worker_main(void *arg) {
+  Worker_t *worker = arg;
+  ThreadPool_t *pool = worker->pool;
+  unsigned seen = wait_generation(pool, 0);
+  while (!atomic_load(&pool->stop)) {
+    run_ranges(pool, worker->id);
+    if (atomic_fetch_sub(&pool->active, 1) == 1) {
+      pthread_mutex_lock(&pool->lock);
+      pthread_cond_signal(&pool->done);
+      pthread_mutex_unlock(&pool->lock);
+    }
+    seen = wait_generation(pool, seen);
+  }
+  return NULL;
+}
+
+ThreadPool_t *pool_create(int threads) {
+  ThreadPool_t *pool = calloc(1, sizeof(ThreadPool_t));
+  if (pool) {
+    pool->threads = threads > 0 ? threads : 1;
+    pool->handles = calloc(pool->threads, sizeof(pthread_t));
+    pool->workers = calloc(pool->threads, sizeof(Worker_t));
+    pool->ranges = calloc(pool->threads, sizeof(WorkRange_t));
+    if (!pool->handles || !pool->workers || !pool->ranges) {
+      free(pool->handles);
+      free(pool->workers);
+      free(pool->ranges);
+      free(pool);
+      pool = NULL;
+    }
+  }
+  if (pool) {
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    atomic_init(&pool->generation, 0);
+    atomic_init(&pool->active, 0);
+    atomic_init(&pool->stop, 0);
+    for (int i = 0; i < pool->threads; i++) {
+      pthread_mutex_init(&pool->ranges[i].lock, NULL);
+      pool->workers[i].pool = pool;
+      pool->workers[i].id = i;
+    }
+    // Если поток не запустился, пул работает с уже запущенными: задание
+    // ждет ровно threads - 1 фоновых потоков, а join - только созданных
+    int started = 1;
+    while (started < pool->threads &&
+           pthread_create(&pool->handles[started], NULL, worker_main,
+                          &pool->workers[started]) == 0) {
+      started++;
+    }
+    for (int i = started; i < pool->threads; i++) {
+      pthread_mutex_destroy(&pool->ranges[i].lock);
+    }
+    pool->threads = started;
+  }
+  return pool;
+}
+
+void pool_destroy(ThreadPool_t *pool) {
+  if (pool) {
+    pthread_mutex_lock(&pool->lock);
+    atomic_store(&pool->stop, 1);
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 1; i < pool->threads; i++) {
+      pthread_join(pool->handles[i], NULL);
+    }
+    for (int i = 0; i < pool->threads; i++) {
+      pthread_mutex_destroy(&pool->ranges[i].lock);
+    }
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->handles);
+    free(pool->workers);
+    free(pool->ranges);
+    free(pool);
+  }
+}
+
+int pool_threads(const ThreadPool_t *pool) { return pool ? pool->threads : 1; }
+
+void pool_parallel_for(ThreadPool_t *pool, int count, PoolTask_t task,
+                       void *arg) {
+  if (!pool || pool->threads == 1 || count <= 1) {
+    for (int i = 0; i < count; i++) {
+      task(arg, i, 0);
+    }
+  } else {
+    // Начальное разбиение поровну, дальше балансирует перехват
+    for (int i = 0; i < pool->threads; i++) {
+      pthread_mutex_lock(&pool->ranges[i].lock);
+      pool->ranges[i].begin = count * i / pool->threads;
+      pool->ranges[i].end = count * (i + 1) / pool->threads;
+      pthread_mutex_unlock(&pool->ranges[i].lock);
+    }
+    pool->task = task;
+    pool->arg = arg;
+    atomic_store(&pool->active, pool->threads - 1);
+
+    pthread_mutex_lock(&pool->lock);
+    atomic_fetch_add(&pool->generation, 1);
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    // Вызывающий поток работает как поток 0
+    run_ranges(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (atomic_load(&pool->active) > 0) {
+      pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+  }
+}
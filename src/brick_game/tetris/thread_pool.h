@@ -0,0 +1,51 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Задача параллельного цикла.
+ * @param arg Общий аргумент, переданный в pool_parallel_for().
+ * @param index Номер итерации.
+ * @param worker Номер потока (0..threads-1), для рабочих буферов потока.
+ */
+typedef void (*PoolTask_t)(void *arg, int index, int worker);
+
+/**
+ * @brief Пул потоков с перехватом работы. Каждый поток получает свой
+ * диапазон итераций и берет их с начала; освободившийся поток забирает
+ * половину оставшегося диапазона у другого потока.
+ */
+typedef struct ThreadPool ThreadPool_t;
+
+/**
+ * @brief Создает пул с заданным числом потоков. Если часть потоков не
+ * запустилась, пул работает с запущенными (см. pool_threads()).
+ * @return Пул или NULL при ошибке.
+ */
+ThreadPool_t *pool_create(int threads);
+
+/**
+ * @brief Останавливает потоки и освобождает пул (может быть NULL).
+ */
+void pool_destroy(ThreadPool_t *pool);
+
+/**
+ * @brief Возвращает число потоков пула (1 для NULL).
+ */
+int pool_threads(const ThreadPool_t *pool);
+
+/**
+ * @brief Выполняет task для итераций 0..count-1 и ждет завершения всех.
+ * Без пула (NULL) итерации выполняются в вызывающем потоке.
+ */
+void pool_parallel_for(ThreadPool_t *pool, int count, PoolTask_t task,
+                       void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // THREAD_POOL_H
@@ -1,8 +1,15 @@
 #include "brick_game_cli.h"
 
-int main() {
+int main(int argc, char *argv[]) {
+#ifdef BRICK_SPECTATOR
+  if (argc > 1) {
+    return spectator_main(argc, argv);
+  }
+#else
+  (void)argc;
+  (void)argv;
+#endif
   setlocale(LC_ALL, "");
-  srand(time(NULL));
   initscr();
   cbreak();
   noecho();
@@ -31,7 +38,9 @@ void printfield(WINDOW *game_win, GameInfo_t tetris) {
 
   for (int i = 0; i < 20 && tetris.field; i++) {
     for (int j = 0; j < 10 && tetris.field[i]; j++) {
-      if (tetris.field[i][j]) {
+      if (tetris.field[i][j] == CELL_GHOST) {
+        mvwprintw(game_win, i + 1, (j + 1) * 2, "::");
+      } else if (tetris.field[i][j]) {
         mvwprintw(game_win, i + 1, (j + 1) * 2, "[]");
       }
     }
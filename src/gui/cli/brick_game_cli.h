@@ -12,6 +12,10 @@
 #include "../../brick_game/snake/snake_controller.h"
 #endif
 
+#ifdef BRICK_SPECTATOR
+#include "spectator.h"
+#endif
+
 /**
  * @brief Отрисовывает игровое поле в указанном окне.
  *
@@ -0,0 +1,251 @@
+#include "spectator.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/// Символы для пары строк поля: пусто, верхняя, нижняя, обе
+static const chtype CELL_PAIRS[4] = {' ', '\'', '.', ':'};
+
+static void restart_tile(SpectatorTile_t *tile) {
+  tetris_destroy(tile->game);
+  tile->game = tetris_create();
+  if (tile->game && tile->replay) {
+    tetris_set_clock(tile->game, Clock_virtual, tile->replay->tick_ms);
+    tetris_set_randomizer(tile->game, (Randomizer_t)tile->replay->rules);
+    tetris_seed(tile->game, tile->replay->seed);
+    replay_cursor(&tile->cursor, tile->replay);
+    tile->pending =
+        replay_next(&tile->cursor, &tile->event_tick, &tile->event);
+  } else if (tile->game) {
+    // Каждая новая партия автоигрока получает следующее зерно
+    tetris_set_clock(tile->game, Clock_virtual, SPECTATOR_TICK_MS);
+    tetris_seed(tile->game, tile->seed++);
+  }
+  tile->tick = 0;
+  tile->step = 0;
+  tile->plan.count = 0;
+  tile->last_y = FIELD_HEIGHT;
+}
+
+static UserAction_t bot_action(SpectatorTile_t *tile,
+                               const BotOptions_t *opts) {
+  const Game_intro *val = tetris_state(tile->game);
+  UserAction_t action = Up;
+  if (val->status == Start_init) {
+    action = Start;
+  } else {
+    // Новая фигура появляется выше предыдущей позиции
+    if (val->fig.y < tile->last_y) {
+      bot_plan(val, opts, &tile->plan);
+      tile->step = 0;
+    }
+    tile->last_y = val->fig.y;
+    if (tile->step < tile->plan.count) {
+      action = tile->plan.actions[tile->step++];
+    }
+  }
+  return action;
+}
+
+void spectator_step_tile(void *arg, int index, int worker) {
+  (void)worker;
+  Spectator_t *view = arg;
+  SpectatorTile_t *tile = &view->tiles[index];
+  for (int i = 0; i < view->speed && tile->game; i++) {
+    UserAction_t action = Up;
+    if (tile->replay) {
+      if (tile->tick >= tile->replay->ticks) {
+        tile->finished++;
+        restart_tile(tile);
+      }
+      if (tile->pending && tile->event_tick == tile->tick) {
+        action = tile->event;
+        tile->pending =
+            replay_next(&tile->cursor, &tile->event_tick, &tile->event);
+      }
+    } else {
+      if (tetris_state(tile->game)->status == Game_over) {
+        tile->finished++;
+        restart_tile(tile);
+      }
+      action = bot_action(tile, &view->bot);
+    }
+    if (tile->game) {
+      tetris_step(tile->game, action);
+      tile->tick++;
+    }
+  }
+}
+
+int spectator_draw_tile(SpectatorTile_t *tile, int index) {
+  int drawn = 0;
+  if (tile->win && tile->game) {
+    GameInfo_t info = tetris_query(tile->game);
+    uint32_t hash = replay_board_hash(&info);
+    if (hash != tile->drawn_hash || info.score != tile->drawn_score ||
+        tile->finished != tile->drawn_finished) {
+      werase(tile->win);
+      box(tile->win, 0, 0);
+      for (int r = 0; r < FIELD_HEIGHT / 2; r++) {
+        for (int c = 0; c < FIELD_WIDTH; c++) {
+          int pair = (info.field[2 * r][c] > 0) |
+                     (info.field[2 * r + 1][c] > 0) << 1;
+          mvwaddch(tile->win, r + 1, c + 1, CELL_PAIRS[pair]);
+        }
+      }
+      char label[TILE_WIDTH];
+      snprintf(label, sizeof(label), "%d/%ld", index, tile->finished);
+      mvwaddnstr(tile->win, 0, 1, label, TILE_WIDTH - 2);
+      snprintf(label, sizeof(label), "%d", info.score);
+      mvwaddnstr(tile->win, TILE_HEIGHT - 1, 1, label, TILE_WIDTH - 2);
+      wnoutrefresh(tile->win);
+
+      tile->drawn_hash = hash;
+      tile->drawn_score = info.score;
+      tile->drawn_finished = (int)tile->finished;
+      drawn = 1;
+    }
+  }
+  return drawn;
+}
+
+int spectator_init(Spectator_t *view, int games, uint64_t seed,
+                   char *paths[], int path_count) {
+  int ok = 1;
+  view->count = games > path_count ? games : path_count;
+  view->speed = 1;
+  view->bot.beam_width = BOT_DEFAULT_BEAM;
+  for (int i = 0; i < path_count && ok; i++) {
+    ok = replay_load(&view->replays[i], paths[i]) &&
+         view->replays[i].game == Replay_tetris;
+    if (!ok) {
+      fprintf(stderr, "Cannot read Tetris replay %s\n", paths[i]);
+    }
+    view->replay_count += ok;
+  }
+  for (int i = 0; i < view->count && ok; i++) {
+    SpectatorTile_t *tile = &view->tiles[i];
+    tile->replay = i < view->replay_count ? &view->replays[i] : NULL;
+    tile->seed = seed + (uint64_t)i * SPECTATOR_MAX_GAMES;
+    tile->drawn_score = -1;
+    restart_tile(tile);
+    ok = tile->game != NULL;
+  }
+  if (ok) {
+    view->pool = pool_create((int)sysconf(_SC_NPROCESSORS_ONLN));
+  }
+  return ok;
+}
+
+void spectator_layout(Spectator_t *view) {
+  view->header = newwin(1, COLS, 0, 0);
+  nodelay(view->header, TRUE);
+  keypad(view->header, TRUE);
+  int per_row = COLS / TILE_WIDTH;
+  int rows = (LINES - 1) / TILE_HEIGHT;
+  for (int i = 0; i < view->count && i < per_row * rows; i++) {
+    view->tiles[i].win = newwin(TILE_HEIGHT, TILE_WIDTH,
+                                1 + (i / per_row) * TILE_HEIGHT,
+                                (i % per_row) * TILE_WIDTH);
+  }
+}
+
+void spectator_free(Spectator_t *view) {
+  for (int i = 0; i < view->count; i++) {
+    if (view->tiles[i].win) {
+      delwin(view->tiles[i].win);
+    }
+    tetris_destroy(view->tiles[i].game);
+  }
+  for (int i = 0; i < view->replay_count; i++) {
+    replay_free(&view->replays[i]);
+  }
+  if (view->header) {
+    delwin(view->header);
+  }
+  pool_destroy(view->pool);
+}
+
+int spectator_input(Spectator_t *view) {
+  // Ввод читается из строки состояния: getch() на stdscr обновил бы весь
+  // экран поверх плиток
+  int ch = wgetch(view->header);
+  if (ch == 'p') {
+    view->paused = !view->paused;
+  } else if (ch == '+' && view->speed < SPECTATOR_MAX_SPEED) {
+    view->speed *= 2;
+  } else if (ch == '-' && view->speed > 1) {
+    view->speed /= 2;
+  }
+  return ch != 'q';
+}
+
+int spectator_main(int argc, char *argv[]) {
+  int games = 16;
+  uint64_t seed = 1;
+  int ok = 1;
+  int opt;
+  while (ok && (opt = getopt(argc, argv, "S:s:")) != -1) {
+    if (opt == 'S') {
+      games = atoi(optarg);
+    } else if (opt == 's') {
+      seed = strtoull(optarg, NULL, 10);
+    } else {
+      ok = 0;
+    }
+  }
+  int path_count = argc - optind;
+  if (!ok || games < 1 || games > SPECTATOR_MAX_GAMES ||
+      path_count > SPECTATOR_MAX_GAMES) {
+    fprintf(stderr, "Usage: %s -S games(1-%d) [-s seed] [replay ...]\n",
+            argv[0], SPECTATOR_MAX_GAMES);
+    return 1;
+  }
+
+  Spectator_t *view = calloc(1, sizeof(Spectator_t));
+  ok = view && spectator_init(view, games, seed, argv + optind, path_count);
+  if (ok) {
+    initscr();
+    cbreak();
+    noecho();
+    curs_set(0);
+    spectator_layout(view);
+
+    int running = 1;
+    while (running) {
+      long long started = current_millis();
+      running = spectator_input(view);
+      if (!view->paused) {
+        pool_parallel_for(view->pool, view->count, spectator_step_tile, view);
+      }
+      int redrawn = 0;
+      long finished = 0;
+      for (int i = 0; i < view->count; i++) {
+        redrawn += spectator_draw_tile(&view->tiles[i], i);
+        finished += view->tiles[i].finished;
+      }
+      werase(view->header);
+      mvwprintw(view->header, 0, 0,
+                "%d games (%d replays)  x%d%s  finished %ld  redrawn %2d  "
+                "%3lld ms  q p + -",
+                view->count, view->replay_count, view->speed,
+                view->paused ? " paused" : "", finished, redrawn,
+                current_millis() - started);
+      wnoutrefresh(view->header);
+      doupdate();
+
+      long long spent = current_millis() - started;
+      if (spent < SPECTATOR_FRAME_MS) {
+        napms((int)(SPECTATOR_FRAME_MS - spent));
+      }
+    }
+    endwin();
+  }
+  if (view) {
+    spectator_free(view);
+  }
+  free(view);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+#ifndef SPECTATOR_H
+#define SPECTATOR_H
+
+#include <ncurses.h>
+
+#include "../../brick_game/tetris/tetris_autoplay.h"
+#include "../../brick_game/tetris/tetris_lib.h"
+#include "../../brick_game/tetris/thread_pool.h"
+
+/**
+ * Плитка поля: рамка, 10 столбцов и 20 строк, по две строки поля в одном
+ * символе. Номер партии пишется в верхней рамке, счет - в нижней.
+ */
+#define TILE_WIDTH (FIELD_WIDTH + 2)
+#define TILE_HEIGHT (FIELD_HEIGHT / 2 + 2)
+
+#define SPECTATOR_MAX_GAMES 64    ///< Ограничение на число партий
+#define SPECTATOR_FRAME_MS 50     ///< Длительность кадра
+#define SPECTATOR_MAX_SPEED 1024  ///< Наибольшее число шагов за кадр
+#define SPECTATOR_TICK_MS 50      ///< Шаг виртуальных часов партий
+
+/**
+ * @brief Одна партия мозаики: автоигрок или воспроизведение записи.
+ */
+typedef struct {
+  TetrisGame *game;        ///< Партия
+  const Replay_t *replay;  ///< Запись или NULL для автоигрока
+  ReplayCursor_t cursor;   ///< Позиция в записи
+  long tick;               ///< Шаг партии
+  long event_tick;         ///< Шаг следующего события записи
+  UserAction_t event;      ///< Следующее событие записи
+  int pending;             ///< Есть ли еще события
+  uint64_t seed;           ///< Зерно партии автоигрока
+  BotPlan_t plan;          ///< План автоигрока для текущей фигуры
+  int step;                ///< Номер следующего действия плана
+  int last_y;              ///< Позиция фигуры на предыдущем шаге
+  long finished;           ///< Сыграно партий (или повторов записи)
+  WINDOW *win;             ///< Окно плитки или NULL, если не помещается
+  uint32_t drawn_hash;     ///< Хэш поля на экране
+  int drawn_score;         ///< Счет на экране
+  int drawn_finished;      ///< Число партий на экране
+} SpectatorTile_t;
+
+/**
+ * @brief Состояние режима наблюдения.
+ */
+typedef struct {
+  SpectatorTile_t tiles[SPECTATOR_MAX_GAMES];
+  Replay_t replays[SPECTATOR_MAX_GAMES];
+  int count;           ///< Количество партий
+  int replay_count;    ///< Сколько из них воспроизводят записи
+  int speed;           ///< Шагов каждой партии за кадр
+  int paused;          ///< Флаг паузы
+  BotOptions_t bot;    ///< Параметры поиска автоигроков
+  ThreadPool_t *pool;  ///< Пул, в котором шагают партии
+  WINDOW *header;      ///< Строка состояния (и источник ввода)
+} Spectator_t;
+
+/**
+ * @brief Режим наблюдения: сетка из многих партий без ввода игрока.
+ *
+ * tetris_cli -S число [-s зерно] [запись ...]. Каждая запись занимает
+ * плитку и воспроизводится по кругу, остальные плитки до заданного числа
+ * играют автоигроки. Партии шагают параллельно в пуле потоков; за кадр
+ * перерисовываются только изменившиеся плитки и экран обновляется одним
+ * doupdate().
+ *
+ * Клавиши: q - выход, p - пауза, + и - - скорость.
+ *
+ * @return Код завершения процесса.
+ */
+int spectator_main(int argc, char *argv[]);
+
+/**
+ * @brief Загружает записи и создает партии.
+ * @return 1 при успехе, 0 при ошибке (сообщение уже напечатано).
+ */
+int spectator_init(Spectator_t *view, int games, uint64_t seed,
+                   char *paths[], int path_count);
+
+/**
+ * @brief Раскладывает плитки по экрану (после initscr()). Партии, которые
+ * не помещаются, продолжают идти без окна.
+ */
+void spectator_layout(Spectator_t *view);
+
+/**
+ * @brief Освобождает партии, окна, записи и пул.
+ */
+void spectator_free(Spectator_t *view);
+
+/**
+ * @brief Задача пула: продвигает одну партию на speed шагов.
+ */
+void spectator_step_tile(void *arg, int index, int worker);
+
+/**
+ * @brief Перерисовывает плитку, если ее поле, счет или число партий
+ * изменились, и переносит ее в виртуальный экран.
+ * @return 1, если плитка перерисована.
+ */
+int spectator_draw_tile(SpectatorTile_t *tile, int index);
+
+/**
+ * @brief Обрабатывает клавиши.
+ * @return 0, если нажат выход.
+ */
+int spectator_input(Spectator_t *view);
+
+#endif  // SPECTATOR_H
@@ -0,0 +1,83 @@
+#include "board_widget.h"
+
+#include <algorithm>
+
+BoardWidget::BoardWidget(int columns, int rows, int cell, QWidget *parent)
+    : QWidget(parent),
+      columns_(columns),
+      rows_(rows),
+      cell_(cell),
+      cells_(columns * rows, 0) {
+  setFixedSize(columns_ * cell_, rows_ * cell_);
+  // Виджет сам закрашивает всю свою область, фон под ним не нужен
+  setAttribute(Qt::WA_OpaquePaintEvent);
+  buildGrid();
+}
+
+bool BoardWidget::setCells(int **field) {
+  bool changed = false;
+  for (int i = 0; i < rows_; i++) {
+    for (int j = 0; j < columns_; j++) {
+      int value = field && field[i] ? field[i][j] : 0;
+      int &cached = cells_[i * columns_ + j];
+      if (cached != value) {
+        cached = value;
+        // Контур клетки выходит на пиксель за ее квадрат
+        update(cellRect(i, j).adjusted(0, 0, 1, 1));
+        changed = true;
+      }
+    }
+  }
+  return changed;
+}
+
+void BoardWidget::paintEvent(QPaintEvent *event) {
+  QPainter painter(this);
+  const QRect dirty = event->rect();
+  painter.drawPixmap(dirty, grid_, dirty);
+
+  // Только клетки, попавшие в область перерисовки
+  int first_row = std::max(0, dirty.top() / cell_);
+  int last_row = std::min(rows_ - 1, dirty.bottom() / cell_);
+  int first_column = std::max(0, dirty.left() / cell_);
+  int last_column = std::min(columns_ - 1, dirty.right() / cell_);
+
+  const QPen block_pen(Qt::gray, 1);
+  const QPen ghost_pen(Qt::lightGray, 1, Qt::DashLine);
+  painter.setBrush(QBrush(Qt::darkGray));
+  painter.setPen(block_pen);
+  for (int i = first_row; i <= last_row; i++) {
+    for (int j = first_column; j <= last_column; j++) {
+      if (cells_[i * columns_ + j] > 0) {
+        painter.drawRect(cellRect(i, j));
+      }
+    }
+  }
+
+  // Тень фигуры - только контур
+  painter.setBrush(Qt::NoBrush);
+  painter.setPen(ghost_pen);
+  for (int i = first_row; i <= last_row; i++) {
+    for (int j = first_column; j <= last_column; j++) {
+      if (cells_[i * columns_ + j] == CELL_GHOST) {
+        painter.drawRect(cellRect(i, j).adjusted(1, 1, -1, -1));
+      }
+    }
+  }
+}
+
+QRect BoardWidget::cellRect(int row, int column) const {
+  return QRect(column * cell_, row * cell_, cell_, cell_);
+}
+
+void BoardWidget::buildGrid() {
+  grid_ = QPixmap(size());
+  grid_.fill(Qt::black);
+  QPainter painter(&grid_);
+  painter.setPen(QPen(Qt::gray, 1));
+  for (int i = 0; i < rows_; i++) {
+    for (int j = 0; j < columns_; j++) {
+      painter.drawRect(j * cell_, i * cell_, cell_, cell_);
+    }
+  }
+}
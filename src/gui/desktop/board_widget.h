@@ -0,0 +1,38 @@
+#ifndef BOARD_WIDGET_H
+#define BOARD_WIDGET_H
+
+#include <QPaintEvent>
+#include <QPainter>
+#include <QPixmap>
+#include <QWidget>
+#include <vector>
+
+#include "../../brick_game/common.h"
+
+// Поле из клеток с собственной отрисовкой. Сетка рисуется один раз в
+// кэшированный слой, а при новом кадре перерисовываются только клетки,
+// значение которых изменилось: каждая из них помечается через
+// update(QRect), и Qt собирает их в одну область перерисовки.
+class BoardWidget : public QWidget {
+ public:
+  BoardWidget(int columns, int rows, int cell, QWidget *parent = nullptr);
+
+  // Принимает кадр (field может быть nullptr - все клетки пустые).
+  // Возвращает true, если хотя бы одна клетка изменилась
+  bool setCells(int **field);
+
+ protected:
+  void paintEvent(QPaintEvent *event) override;
+
+ private:
+  QRect cellRect(int row, int column) const;
+  void buildGrid();
+
+  int columns_;
+  int rows_;
+  int cell_;
+  std::vector<int> cells_;
+  QPixmap grid_;
+};
+
+#endif  // BOARD_WIDGET_H
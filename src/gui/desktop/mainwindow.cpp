@@ -4,9 +4,6 @@ constexpr int widthPixel = 10;
 constexpr int heightPixel = 20;
 constexpr int pixel = 30;
 constexpr int pixelNext = 20;
-constexpr int widthField = widthPixel * pixel;
-constexpr int heightField = heightPixel * pixel;
-constexpr int sizeFieldNext = 4 * pixel;
 
 void setFusionDarkTheme();  // темная тема
 
@@ -45,14 +42,17 @@ void BrickGameView::setupUI() {
   QVBoxLayout *rightLayout = new QVBoxLayout();
 
   // Игровое поле
-  gameArea = new QLabel();
-  gameArea->setFixedSize(widthField, heightField);
+  gameArea = new BoardWidget(widthPixel, heightPixel, pixel);
 
   leftLayout->addWidget(gameArea);
 
-  // Область для следующей фигуры
-  nextPieceArea = new QLabel();
-  nextPieceArea->setFixedSize(sizeFieldNext, sizeFieldNext);
+  // Область для следующей фигуры (4x4). У змейки ее нет: область
+  // скрывается, но место в раскладке за ней остается, чтобы метки ниже не
+  // сдвигались
+  nextPieceArea = new BoardWidget(4, 4, pixel);
+  QSizePolicy nextPolicy = nextPieceArea->sizePolicy();
+  nextPolicy.setRetainSizeWhenHidden(true);
+  nextPieceArea->setSizePolicy(nextPolicy);
 
   scoreLabel = new QLabel("Score: 0");
   highScoreLabel = new QLabel("High Score: 0");
@@ -125,68 +125,26 @@ void BrickGameView::keyPressEvent(QKeyEvent *event) {
 }
 
 void BrickGameView::drawGame() {
-  QPixmap pixmap(widthField, heightField);
-  pixmap.fill(Qt::black);
-
-  QPainter painter(&pixmap);
-  painter.setPen(QPen(Qt::gray, 1));
-
-  // Отрисовка сетки
-  for (int i = 0; i < 10; i++) {
-    for (int j = 0; j < 20; j++) {
-      painter.drawRect(i * pixel, j * pixel, pixel, pixel);
-    }
-  }
-
   GameInfo_t info = controller.getGameInfo();
-  scoreLabel->setText(QString("Score: %1").arg(info.score));
-  highScoreLabel->setText(QString("High Score: %1").arg(info.high_score));
-  levelLabel->setText(QString("Level: %1").arg(info.level));
-  speedLabel->setText(QString("Speed: %1").arg(info.speed));
-
-  painter.setBrush(QBrush(Qt::darkGray));
-  for (int i = 0; i < 20; i++) {
-    for (int j = 0; j < 10; j++) {
-      if (info.field[i][j]) {
-        painter.drawRect(j * pixel, i * pixel, pixel, pixel);
-      }
-    }
+
+  // Перерисовываются только изменившиеся клетки и метки; на паузе и в
+  // ожидании кадр ничего не меняет и отрисовки нет совсем
+  gameArea->setCells(info.field);
+  if (nextPieceArea->isHidden() == (info.next != nullptr)) {
+    nextPieceArea->setVisible(info.next != nullptr);
   }
+  nextPieceArea->setCells(info.next);
 
-  gameArea->setPixmap(pixmap);
-  drawNextPiece(info);
+  updateLabel(scoreLabel, "Score", info.score, shownScore);
+  updateLabel(highScoreLabel, "High Score", info.high_score, shownHighScore);
+  updateLabel(levelLabel, "Level", info.level, shownLevel);
+  updateLabel(speedLabel, "Speed", info.speed, shownSpeed);
 }
 
-void BrickGameView::drawNextPiece(const GameInfo_t &info) {
-  if (!info.next) return;
-
-  QPixmap nextPixmap(sizeFieldNext, sizeFieldNext);
-  nextPixmap.fill(Qt::black);
-
-  QPainter painter(&nextPixmap);
-  painter.setPen(QPen(Qt::gray, 1));
-
-  // Центрируем фигуру (4x4)
-  static const int offsetX = (sizeFieldNext - 4 * pixel) / 2;
-  static const int offsetY = (sizeFieldNext - 4 * pixel) / 2;
-
-  // Отрисовка сетки для следующей фигуры
-  for (int i = 0; i < 4; i++) {
-    for (int j = 0; j < 4; j++) {
-      painter.drawRect(offsetX + j * pixel, offsetY + i * pixel, pixel, pixel);
-    }
-  }
-
-  // Отрисовка следующей фигуры
-  painter.setBrush(QBrush(Qt::darkGray));
-  for (int i = 0; i < 4; i++) {
-    for (int j = 0; j < 4; j++) {
-      if (info.next[i][j]) {
-        painter.drawRect(offsetX + j * pixel, offsetY + i * pixel, pixel,
-                         pixel);
-      }
-    }
+void BrickGameView::updateLabel(QLabel *label, const char *title, int value,
+                                int &shown) {
+  if (value != shown) {
+    shown = value;
+    label->setText(QString("%1: %2").arg(title).arg(value));
   }
-
-  nextPieceArea->setPixmap(nextPixmap);
-}
\ No newline at end of file
+}
@@ -14,6 +14,7 @@
 // Включаем общие типы
 #include "../../brick_game/common.h"
 #include "../../brick_game/controller.h"
+#include "board_widget.h"
 
 class BrickGameView : public QMainWindow {
   Q_OBJECT
@@ -30,12 +31,14 @@ class BrickGameView : public QMainWindow {
 
  private:
   void setupUI();
-  void drawNextPiece(const GameInfo_t &info);
+  // Меняет текст метки, только если значение изменилось
+  static void updateLabel(QLabel *label, const char *title, int value,
+                          int &shown);
 
   // UI элементы
   QWidget *centralWidget;
-  QLabel *gameArea;
-  QLabel *nextPieceArea;
+  BoardWidget *gameArea;
+  BoardWidget *nextPieceArea;
   QLabel *scoreLabel;
   QLabel *highScoreLabel;
   QLabel *levelLabel;
@@ -44,6 +47,12 @@ class BrickGameView : public QMainWindow {
   QLabel *pauseQuit;
   QTimer *gameTimer;
 
+  // Значения, которые сейчас показаны в метках
+  int shownScore = 0;
+  int shownHighScore = 0;
+  int shownLevel = 1;
+  int shownSpeed = 1;
+
   s21::Controller controller;
 };
 
@@ -0,0 +1,70 @@
+#include <getopt.h>
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "server.h"
+
+namespace {
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void requestStop(int) { stop_requested = 1; }
+
+void usage(const char* name) {
+  std::fprintf(stderr,
+               "Usage: %s [-u socket_path | -p tcp_port] [-t tick_ms]\n",
+               name);
+}
+
+}  // namespace
+
+// brickd: сервер партий тетриса и змейки для тонких клиентов. По умолчанию
+// слушает Unix-сокет /tmp/brickd.sock, с -p - TCP на 127.0.0.1.
+int main(int argc, char* argv[]) {
+  std::string path = "/tmp/brickd.sock";
+  int port = -1;
+  int tick_ms = s21::BrickServer::TICK_MS;
+  bool ok = true;
+  int opt = 0;
+  while (ok && (opt = getopt(argc, argv, "u:p:t:")) != -1) {
+    if (opt == 'u') {
+      path = optarg;
+    } else if (opt == 'p') {
+      port = std::atoi(optarg);
+    } else if (opt == 't') {
+      tick_ms = std::atoi(optarg);
+    } else {
+      ok = false;
+    }
+  }
+  ok = ok && tick_ms > 0;
+
+  s21::BrickServer server(tick_ms);
+  if (ok) {
+    ok = port >= 0 ? server.listenTcp(port) : server.listenUnix(path);
+    if (!ok) std::perror("brickd: listen");
+  } else {
+    usage(argv[0]);
+  }
+
+  if (ok) {
+    // Без SA_RESTART сигнал прерывает epoll_wait и цикл видит флаг
+    struct sigaction action {};
+    action.sa_handler = requestStop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    if (port >= 0) {
+      std::printf("brickd: 127.0.0.1:%d\n", server.port());
+    } else {
+      std::printf("brickd: %s\n", path.c_str());
+    }
+    std::fflush(stdout);
+    while (!stop_requested) {
+      server.runOnce(-1);
+    }
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,225 @@
+#include "frame_codec.h"
+
+#include <cstring>
+
+#include "session.h"
+
+namespace s21 {
+
+namespace {
+
+constexpr int FIELD_CELLS = BRICK_BOARD_HEIGHT * BRICK_BOARD_WIDTH;
+constexpr int NEXT_CELLS = BRICK_NEXT_SIZE * BRICK_NEXT_SIZE;
+constexpr std::uint8_t ALL_FLAGS = 0xFF;
+// seq, flags, пять полей, next, один отрезок на все поле
+constexpr std::size_t KEYFRAME_BYTES = 4 + 1 + 5 * 4 + 1 + NEXT_CELLS / 2 +
+                                       1 + 2 + FIELD_CELLS / 2;
+
+struct Scalar {
+  DeltaFlag flag;
+  std::int32_t BrickFrame_t::*member;
+};
+
+constexpr Scalar SCALARS[] = {
+    {Delta_score, &BrickFrame_t::score},
+    {Delta_high_score, &BrickFrame_t::high_score},
+    {Delta_level, &BrickFrame_t::level},
+    {Delta_speed, &BrickFrame_t::speed},
+    {Delta_pause, &BrickFrame_t::pause}};
+
+const std::int8_t* fieldCells(const BrickFrame_t& frame) {
+  return &frame.field[0][0];
+}
+
+std::int8_t* fieldCells(BrickFrame_t& frame) { return &frame.field[0][0]; }
+
+void put(std::vector<std::uint8_t>& out, const void* data, std::size_t size) {
+  const auto* bytes = static_cast<const std::uint8_t*>(data);
+  out.insert(out.end(), bytes, bytes + size);
+}
+
+// Клетки по две в байт: младшие 4 бита - первая клетка
+void putCells(std::vector<std::uint8_t>& out, const std::int8_t* cells,
+              int count) {
+  for (int i = 0; i < count; i += 2) {
+    std::uint8_t low = static_cast<std::uint8_t>(cells[i]) & 0x0F;
+    std::uint8_t high =
+        i + 1 < count ? static_cast<std::uint8_t>(cells[i + 1]) & 0x0F : 0;
+    out.push_back(static_cast<std::uint8_t>(low | high << 4));
+  }
+}
+
+// Чтение кадра с проверкой границ: после первой ошибки ok остается false
+struct Reader {
+  const std::uint8_t* data;
+  std::size_t size;
+  std::size_t pos{0};
+  bool ok{true};
+
+  void take(void* dst, std::size_t count) {
+    ok = ok && size - pos >= count;
+    if (ok) {
+      std::memcpy(dst, data + pos, count);
+      pos += count;
+    }
+  }
+
+  void cells(std::int8_t* dst, int first, int count) {
+    std::size_t bytes = static_cast<std::size_t>(count + 1) / 2;
+    ok = ok && size - pos >= bytes;
+    for (int i = 0; ok && i < count; ++i) {
+      std::uint8_t byte = data[pos + i / 2];
+      int nibble = i % 2 ? byte >> 4 : byte & 0x0F;
+      dst[first + i] = static_cast<std::int8_t>(nibble >= 8 ? nibble - 16
+                                                            : nibble);
+    }
+    pos += ok ? bytes : 0;
+  }
+};
+
+// Дописывает в out разницу frame с base (опорный кадр - все целиком).
+// Возвращает флаги кадра; 0 - картинка не изменилась.
+std::uint8_t writeDelta(const BrickFrame_t& base, const BrickFrame_t& frame,
+                        bool key, std::vector<std::uint8_t>& out) {
+  std::uint8_t flags = key ? ALL_FLAGS : 0;
+  for (const Scalar& scalar : SCALARS) {
+    if (frame.*scalar.member != base.*scalar.member) flags |= scalar.flag;
+  }
+  if (frame.has_next != base.has_next ||
+      std::memcmp(frame.next, base.next, sizeof(frame.next))) {
+    flags |= Delta_next;
+  }
+  if (std::memcmp(frame.field, base.field, sizeof(frame.field))) {
+    flags |= Delta_field;
+  }
+
+  if (flags) {
+    put(out, &frame.seq, sizeof(frame.seq));
+    out.push_back(flags);
+    for (const Scalar& scalar : SCALARS) {
+      if (flags & scalar.flag) {
+        put(out, &(frame.*scalar.member), sizeof(std::int32_t));
+      }
+    }
+    if (flags & Delta_next) {
+      out.push_back(frame.has_next);
+      putCells(out, &frame.next[0][0], NEXT_CELLS);
+    }
+  }
+
+  if (flags & Delta_field) {
+    const std::int8_t* now = fieldCells(frame);
+    const std::int8_t* was = fieldCells(base);
+    auto changed = [&](int i) { return key || now[i] != was[i]; };
+    std::size_t count_pos = out.size();
+    out.push_back(0);
+    int cell = 0;
+    while (cell < FIELD_CELLS) {
+      if (changed(cell)) {
+        // Отрезок тянется, пока до следующей измененной клетки не больше
+        // MERGE_GAP неизменных
+        int end = cell + 1;
+        int probe = end;
+        while (probe < FIELD_CELLS && probe - end <= FrameEncoder::MERGE_GAP) {
+          if (changed(probe)) end = probe + 1;
+          ++probe;
+        }
+        out.push_back(static_cast<std::uint8_t>(cell));
+        out.push_back(static_cast<std::uint8_t>(end - cell));
+        putCells(out, now + cell, end - cell);
+        out[count_pos]++;
+        cell = end;
+      } else {
+        ++cell;
+      }
+    }
+  }
+  return flags;
+}
+
+}  // namespace
+
+bool FrameEncoder::encode(const BrickFrame_t& frame,
+                          std::vector<std::uint8_t>& out) {
+  BrickFrame_t next = frame;
+  next.seq = last_.seq + 1;
+  bool key = key_due_ || since_key_ >= keyframe_interval_;
+  // Кадр пишется сразу в out после места под заголовок, а размер
+  // вписывается в заголовок в конце: без промежуточного буфера на кадр
+  std::size_t start = out.size();
+  std::size_t body_start = start + sizeof(BrickFrameHeader_t);
+  out.resize(body_start);
+  std::uint8_t flags = key ? 0 : writeDelta(last_, next, false, out);
+  // Разница больше опорного кадра бывает после очистки многих линий
+  if (key || out.size() - body_start > KEYFRAME_BYTES) {
+    out.resize(body_start);
+    key = true;
+    flags = writeDelta(last_, next, true, out);
+  }
+
+  if (flags) {
+    BrickFrameHeader_t header{};
+    header.size = static_cast<std::uint16_t>(out.size() - body_start);
+    header.type = Frame_delta;
+    std::memcpy(out.data() + start, &header, sizeof(header));
+    last_ = next;
+    since_key_ = key ? 1 : since_key_ + 1;
+    key_due_ = false;
+  } else {
+    out.resize(start);
+  }
+  return flags != 0;
+}
+
+bool FrameEncoder::encode(const GameInfo_t& info,
+                          std::vector<std::uint8_t>& out) {
+  BrickFrame_t frame{};
+  Session::fillFrame(info, frame);
+  return encode(frame, out);
+}
+
+bool FrameDecoder::decode(std::uint8_t type, const std::uint8_t* data,
+                          std::size_t size) {
+  BrickFrame_t frame = frame_;
+  bool ok = false;
+  if (type == Frame_full) {
+    ok = size == sizeof(frame);
+    if (ok) std::memcpy(&frame, data, sizeof(frame));
+  } else if (type == Frame_delta) {
+    Reader reader{data, size};
+    std::uint32_t seq = 0;
+    std::uint8_t flags = 0;
+    reader.take(&seq, sizeof(seq));
+    reader.take(&flags, sizeof(flags));
+    bool key = flags & Delta_key;
+    ok = key || (ready_ && seq == frame_.seq + 1);
+    if (key) frame = BrickFrame_t{};
+    frame.seq = seq;
+    for (const Scalar& scalar : SCALARS) {
+      if (flags & scalar.flag) {
+        reader.take(&(frame.*scalar.member), sizeof(std::int32_t));
+      }
+    }
+    if (flags & Delta_next) {
+      reader.take(&frame.has_next, sizeof(frame.has_next));
+      reader.cells(&frame.next[0][0], 0, NEXT_CELLS);
+    }
+    std::uint8_t runs = 0;
+    if (flags & Delta_field) reader.take(&runs, sizeof(runs));
+    for (int i = 0; reader.ok && i < runs; ++i) {
+      std::uint8_t first = 0;
+      std::uint8_t length = 0;
+      reader.take(&first, sizeof(first));
+      reader.take(&length, sizeof(length));
+      reader.ok = reader.ok && first + length <= FIELD_CELLS;
+      reader.cells(fieldCells(frame), first, length);
+    }
+    ok = ok && reader.ok && reader.pos == size;
+  }
+
+  if (ok) frame_ = frame;
+  ready_ = ok;
+  return ok;
+}
+
+}  // namespace s21
@@ -0,0 +1,80 @@
+#ifndef BRICK_FRAME_CODEC_H
+#define BRICK_FRAME_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../brick_game/common.h"
+#include "protocol.h"
+
+namespace s21 {
+
+// Кадр Frame_delta:
+//   uint32 seq, uint8 flags (DeltaFlag),
+//   int32 на каждое поле из score..pause, отмеченное во flags,
+//   при Delta_next - uint8 has_next и 16 клеток next,
+//   при Delta_field - uint8 число отрезков и отрезки: uint8 первая клетка
+//   (y * 10 + x), uint8 длина и клетки отрезка.
+// Клетки упакованы по две в байт, по 4 бита со знаком, так что помещаются
+// и тень (-1), и все виды клеток змейки. Опорный кадр (Delta_key) несет
+// все поля и все поле одним отрезком; он не зависит от прошлых кадров.
+enum DeltaFlag : std::uint8_t {
+  Delta_key = 0x01,
+  Delta_score = 0x02,
+  Delta_high_score = 0x04,
+  Delta_level = 0x08,
+  Delta_speed = 0x10,
+  Delta_pause = 0x20,
+  Delta_next = 0x40,
+  Delta_field = 0x80
+};
+
+// Сжимает поток кадров одной партии в разницы с прошлым кадром. Змейка за
+// шаг меняет две-три клетки, и кадр занимает около 20 байт вместо 248.
+class FrameEncoder {
+ public:
+  // Через сколько кадров повторяется опорный кадр
+  static constexpr std::uint32_t KEYFRAME_INTERVAL = 64;
+  // Столько неизменных клеток дешевле передать, чем начать новый отрезок
+  static constexpr int MERGE_GAP = 2;
+
+  explicit FrameEncoder(std::uint32_t keyframe_interval = KEYFRAME_INTERVAL)
+      : keyframe_interval_(keyframe_interval) {}
+
+  // Дописывает в out заголовок и кадр. Если картинка не изменилась и
+  // опорный кадр не нужен, ничего не пишет и возвращает false.
+  bool encode(const BrickFrame_t& frame, std::vector<std::uint8_t>& out);
+  bool encode(const GameInfo_t& info, std::vector<std::uint8_t>& out);
+
+  // Следующий кадр будет опорным (например, для нового зрителя)
+  void requestKeyframe() { key_due_ = true; }
+  // Номер последнего записанного кадра
+  std::uint32_t seq() const { return last_.seq; }
+
+ private:
+  BrickFrame_t last_{};
+  std::uint32_t keyframe_interval_;
+  std::uint32_t since_key_{0};
+  bool key_due_{true};
+};
+
+// Восстанавливает кадры из потока FrameEncoder. Принимает и Frame_full.
+class FrameDecoder {
+ public:
+  // Применяет кадр. Битый кадр или пропуск в номерах возвращает false;
+  // тогда декодер ждет следующего опорного кадра.
+  bool decode(std::uint8_t type, const std::uint8_t* data, std::size_t size);
+
+  // Есть ли картинка, от которой считаются разницы
+  bool ready() const { return ready_; }
+  const BrickFrame_t& frame() const { return frame_; }
+
+ private:
+  BrickFrame_t frame_{};
+  bool ready_{false};
+};
+
+}  // namespace s21
+
+#endif  // BRICK_FRAME_CODEC_H
@@ -0,0 +1,83 @@
+#ifndef BRICK_PROTOCOL_H
+#define BRICK_PROTOCOL_H
+
+#include <stdint.h>
+
+/**
+ * Протокол brickd. Сервер и клиенты работают на одной машине, поэтому все
+ * числа передаются в родном порядке байт.
+ *
+ * Клиент шлет запросы фиксированного размера BrickRequest_t: сначала
+ * Request_join с номером игры, затем Request_input с действиями. Сервер
+ * отвечает кадрами: заголовок BrickFrameHeader_t и size байт данных.
+ * Кадр отправляется только тогда, когда картинка партии изменилась.
+ *
+ * Сервер шлет кадры Frame_delta (см. frame_codec.h): поля, изменившиеся с
+ * прошлого кадра, и отрезки измененных клеток поля по 4 бита на клетку.
+ * Периодически приходит опорный кадр с полной картинкой, от которого
+ * клиент может начать декодирование.
+ */
+#define BRICK_BOARD_HEIGHT 20
+#define BRICK_BOARD_WIDTH 10
+#define BRICK_NEXT_SIZE 4
+
+/**
+ * @brief Вид запроса клиента.
+ */
+typedef enum {
+  Request_join = 1,  ///< Создать партию, arg - игра (BrickGameKind_t)
+  Request_input = 2  ///< Действие, arg - UserAction_t, hold - удержание
+} BrickRequestType_t;
+
+/**
+ * @brief Игра сессии.
+ */
+typedef enum {
+  Brick_tetris = 0,
+  Brick_snake = 1
+} BrickGameKind_t;
+
+/**
+ * @brief Запрос клиента.
+ */
+typedef struct {
+  uint8_t type;  ///< BrickRequestType_t
+  uint8_t arg;
+  uint8_t hold;
+  uint8_t reserved;
+} BrickRequest_t;
+
+/**
+ * @brief Вид кадра сервера.
+ */
+typedef enum {
+  Frame_full = 1,  ///< BrickFrame_t целиком
+  Frame_delta = 2  ///< Разница с прошлым кадром или опорный кадр
+} BrickFrameType_t;
+
+/**
+ * @brief Заголовок кадра.
+ */
+typedef struct {
+  uint16_t size;  ///< Байт данных после заголовка
+  uint8_t type;   ///< BrickFrameType_t
+  uint8_t reserved;
+} BrickFrameHeader_t;
+
+/**
+ * @brief Полный кадр: GameInfo_t без указателей.
+ */
+typedef struct {
+  uint32_t seq;  ///< Номер кадра в сессии
+  int32_t score;
+  int32_t high_score;
+  int32_t level;
+  int32_t speed;
+  int32_t pause;
+  int8_t field[BRICK_BOARD_HEIGHT][BRICK_BOARD_WIDTH];
+  int8_t next[BRICK_NEXT_SIZE][BRICK_NEXT_SIZE];
+  uint8_t has_next;  ///< 0, если у игры нет следующей фигуры
+  uint8_t reserved[3];
+} BrickFrame_t;
+
+#endif  // BRICK_PROTOCOL_H
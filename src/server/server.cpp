@@ -0,0 +1,294 @@
+#include "server.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace s21 {
+
+namespace {
+
+constexpr int MAX_EVENTS = 64;
+constexpr std::size_t READ_CHUNK = 4096;
+
+bool setEvents(int epoll_fd, int op, int fd, std::uint32_t events) {
+  epoll_event event{};
+  event.events = events;
+  event.data.fd = fd;
+  return epoll_ctl(epoll_fd, op, fd, &event) == 0;
+}
+
+}  // namespace
+
+BrickServer::BrickServer(int tick_ms) : tick_ms_(tick_ms) {
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (epoll_fd_ >= 0 && timer_fd_ >= 0) {
+    itimerspec period{};
+    period.it_interval.tv_sec = tick_ms_ / 1000;
+    period.it_interval.tv_nsec = (tick_ms_ % 1000) * 1000000L;
+    period.it_value = period.it_interval;
+    timerfd_settime(timer_fd_, 0, &period, nullptr);
+    setEvents(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, EPOLLIN);
+  }
+}
+
+BrickServer::~BrickServer() {
+  for (auto& [fd, client] : clients_) {
+    close(fd);
+  }
+  for (int fd : {listen_fd_, timer_fd_, epoll_fd_}) {
+    if (fd >= 0) close(fd);
+  }
+  if (!unix_path_.empty()) {
+    unlink(unix_path_.c_str());
+  }
+}
+
+bool BrickServer::startListening(int fd) {
+  bool ok = listen(fd, SOMAXCONN) == 0 &&
+            setEvents(epoll_fd_, EPOLL_CTL_ADD, fd, EPOLLIN);
+  if (ok) {
+    listen_fd_ = fd;
+  } else {
+    close(fd);
+  }
+  return ok;
+}
+
+bool BrickServer::listenUnix(const std::string& path) {
+  sockaddr_un addr{};
+  bool ok = epoll_fd_ >= 0 && listen_fd_ < 0 &&
+            path.size() < sizeof(addr.sun_path);
+  int fd = ok ? socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)
+              : -1;
+  ok = fd >= 0;
+  if (ok) {
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    unlink(path.c_str());
+    ok = bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    if (!ok) close(fd);
+  }
+  ok = ok && startListening(fd);
+  if (ok) {
+    unix_path_ = path;
+  }
+  return ok;
+}
+
+bool BrickServer::listenTcp(int port) {
+  bool ok = epoll_fd_ >= 0 && listen_fd_ < 0;
+  int fd = ok ? socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)
+              : -1;
+  ok = fd >= 0;
+  if (ok) {
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<std::uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t size = sizeof(addr);
+    ok = bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 &&
+         getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &size) == 0;
+    port_ = ntohs(addr.sin_port);
+    if (!ok) close(fd);
+  }
+  return ok && startListening(fd);
+}
+
+void BrickServer::run() {
+  running_ = true;
+  while (running_) {
+    runOnce(-1);
+  }
+}
+
+void BrickServer::runOnce(int timeout_ms) {
+  epoll_event events[MAX_EVENTS];
+  int count = epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout_ms);
+  for (int i = 0; i < count; ++i) {
+    int fd = events[i].data.fd;
+    auto it = clients_.find(fd);
+    if (fd == listen_fd_) {
+      acceptClients();
+    } else if (fd == timer_fd_) {
+      std::uint64_t expirations = 0;
+      if (read(timer_fd_, &expirations, sizeof(expirations)) ==
+          sizeof(expirations)) {
+        int ticks = static_cast<int>(
+            std::min<std::uint64_t>(expirations, MAX_CATCH_UP));
+        for (int t = 0; t < ticks; ++t) tick();
+      }
+    } else if (it != clients_.end()) {
+      if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        readClient(*it->second);
+      }
+      if (events[i].events & EPOLLOUT) {
+        writeClient(*it->second);
+      }
+    }
+  }
+  flushFrames();
+
+  // Клиенты закрываются после разбора всех событий, чтобы номер
+  // дескриптора не достался новому клиенту посреди пачки
+  for (int fd : closing_) {
+    closeClient(fd);
+  }
+  closing_.clear();
+}
+
+std::size_t BrickServer::sessionCount() const {
+  return static_cast<std::size_t>(
+      std::count_if(clients_.begin(), clients_.end(), [](const auto& entry) {
+        return entry.second->session != nullptr;
+      }));
+}
+
+std::size_t BrickServer::pendingBytes() const {
+  std::size_t bytes = 0;
+  for (const auto& [fd, client] : clients_) {
+    bytes += client->out.size() - client->out_pos;
+  }
+  return bytes;
+}
+
+void BrickServer::acceptClients() {
+  int fd = 0;
+  while ((fd = accept4(listen_fd_, nullptr, nullptr,
+                       SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+    if (setEvents(epoll_fd_, EPOLL_CTL_ADD, fd, EPOLLIN)) {
+      auto client = std::make_unique<Client>();
+      client->fd = fd;
+      clients_[fd] = std::move(client);
+    } else {
+      close(fd);
+    }
+  }
+}
+
+void BrickServer::readClient(Client& client) {
+  bool open = true;
+  bool more = true;
+  while (open && more) {
+    std::size_t size = client.in.size();
+    client.in.resize(size + READ_CHUNK);
+    ssize_t got = recv(client.fd, client.in.data() + size, READ_CHUNK, 0);
+    client.in.resize(size + (got > 0 ? static_cast<std::size_t>(got) : 0));
+    more = got > 0;
+    open = got > 0 || (got < 0 && (errno == EAGAIN || errno == EINTR));
+  }
+
+  // Разбираются только целые запросы, хвост ждет следующего чтения
+  std::size_t pos = 0;
+  while (open && client.in.size() - pos >= sizeof(BrickRequest_t)) {
+    BrickRequest_t request;
+    std::memcpy(&request, client.in.data() + pos, sizeof(request));
+    pos += sizeof(request);
+    open = handleRequest(client, request);
+  }
+  client.in.erase(client.in.begin(), client.in.begin() + pos);
+
+  if (!open) {
+    closing_.push_back(client.fd);
+  }
+}
+
+bool BrickServer::handleRequest(Client& client, const BrickRequest_t& request) {
+  bool ok = false;
+  if (request.type == Request_join) {
+    client.session = Session::create(request.arg);
+    client.encoder.requestKeyframe();
+    client.dirty = true;
+    ok = client.session != nullptr;
+  } else if (request.type == Request_input && client.session &&
+             request.arg <= Action && request.arg != Terminate) {
+    client.session->input(static_cast<UserAction_t>(request.arg),
+                          request.hold != 0);
+    client.dirty = true;
+    ok = true;
+  }
+  // Terminate, неизвестный запрос или ввод до join закрывают соединение
+  return ok;
+}
+
+void BrickServer::tick() {
+  for (auto& [fd, client] : clients_) {
+    if (client->session) {
+      client->session->tick();
+      client->dirty = true;
+    }
+  }
+}
+
+void BrickServer::flushFrames() {
+  for (auto& [fd, client] : clients_) {
+    if (client->dirty && client->session &&
+        client->out.size() - client->out_pos <= MAX_BACKLOG) {
+      sendFrame(*client);
+      client->dirty = false;
+    }
+  }
+}
+
+void BrickServer::sendFrame(Client& client) {
+  if (client.encoder.encode(client.session->info(), client.out)) {
+    writeClient(client);
+  }
+}
+
+void BrickServer::writeClient(Client& client) {
+  bool failed = false;
+  bool blocked = false;
+  while (client.out_pos < client.out.size() && !failed && !blocked) {
+    ssize_t sent = send(client.fd, client.out.data() + client.out_pos,
+                        client.out.size() - client.out_pos, MSG_NOSIGNAL);
+    if (sent > 0) {
+      client.out_pos += static_cast<std::size_t>(sent);
+    } else {
+      blocked = sent < 0 && (errno == EAGAIN || errno == EINTR);
+      failed = !blocked;
+    }
+  }
+
+  if (failed) {
+    closing_.push_back(client.fd);
+  } else if (client.out_pos == client.out.size()) {
+    client.out.clear();
+    client.out_pos = 0;
+    if (client.writing) {
+      client.writing = false;
+      setEvents(epoll_fd_, EPOLL_CTL_MOD, client.fd, EPOLLIN);
+    }
+  } else {
+    // Отправленное начало буфера больше не нужно
+    client.out.erase(client.out.begin(), client.out.begin() + client.out_pos);
+    client.out_pos = 0;
+    if (!client.writing) {
+      client.writing = true;
+      setEvents(epoll_fd_, EPOLL_CTL_MOD, client.fd, EPOLLIN | EPOLLOUT);
+    }
+  }
+}
+
+void BrickServer::closeClient(int fd) {
+  auto it = clients_.find(fd);
+  if (it != clients_.end()) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    clients_.erase(it);
+  }
+}
+
+}  // namespace s21
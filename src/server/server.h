@@ -0,0 +1,88 @@
+#ifndef BRICK_SERVER_H
+#define BRICK_SERVER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "frame_codec.h"
+#include "protocol.h"
+#include "session.h"
+
+namespace s21 {
+
+// Сервер сессий: один поток, один epoll. В epoll зарегистрированы
+// слушающий сокет, timerfd с шагом игр и все клиенты. Все сокеты
+// неблокирующие; то, что не ушло сразу, ждет в буфере клиента EPOLLOUT.
+// Кадр строится только для сессий, которые получили ввод или шаг, и
+// отправляется, только если картинка изменилась, в виде разницы с прошлым
+// отправленным кадром.
+class BrickServer {
+ public:
+  static constexpr int TICK_MS = 50;  // Как кадр CLI
+  // Сколько шагов догоняется, если цикл отстал от таймера
+  static constexpr int MAX_CATCH_UP = 4;
+  // Клиент, у которого в очереди больше, пропускает кадры
+  static constexpr std::size_t MAX_BACKLOG = 64 * 1024;
+
+  explicit BrickServer(int tick_ms = TICK_MS);
+  ~BrickServer();
+  BrickServer(const BrickServer&) = delete;
+  BrickServer& operator=(const BrickServer&) = delete;
+
+  // Слушает Unix-сокет (старый файл сокета удаляется)
+  bool listenUnix(const std::string& path);
+  // Слушает TCP на 127.0.0.1; port 0 - любой свободный
+  bool listenTcp(int port);
+  // Фактический TCP-порт после listenTcp()
+  int port() const { return port_; }
+
+  // Обрабатывает события, пришедшие за timeout_ms (-1 - ждать)
+  void runOnce(int timeout_ms);
+  // Цикл до stop()
+  void run();
+  void stop() { running_ = false; }
+
+  std::size_t clientCount() const { return clients_.size(); }
+  std::size_t sessionCount() const;
+  // Байты кадров, которые ждут отправки во всех клиентах
+  std::size_t pendingBytes() const;
+
+ private:
+  struct Client {
+    int fd{-1};
+    std::unique_ptr<Session> session;
+    std::vector<std::uint8_t> in;
+    std::vector<std::uint8_t> out;
+    std::size_t out_pos{0};
+    bool writing{false};  // Подписан на EPOLLOUT
+    bool dirty{false};  // Сессия изменилась после последнего кадра
+    FrameEncoder encoder;
+  };
+
+  bool startListening(int fd);
+  void acceptClients();
+  void readClient(Client& client);
+  bool handleRequest(Client& client, const BrickRequest_t& request);
+  void tick();
+  void flushFrames();
+  void sendFrame(Client& client);
+  void writeClient(Client& client);
+  void closeClient(int fd);
+
+  int tick_ms_;
+  int epoll_fd_{-1};
+  int listen_fd_{-1};
+  int timer_fd_{-1};
+  int port_{0};
+  std::string unix_path_;
+  bool running_{false};
+  std::unordered_map<int, std::unique_ptr<Client>> clients_;
+  std::vector<int> closing_;
+};
+
+}  // namespace s21
+
+#endif  // BRICK_SERVER_H
@@ -0,0 +1,36 @@
+#include "session.h"
+
+namespace s21 {
+
+std::unique_ptr<Session> Session::create(int game) {
+  std::unique_ptr<Session> session;
+  if (game == Brick_tetris) {
+    session = makeTetrisSession();
+  } else if (game == Brick_snake) {
+    session = makeSnakeSession();
+  }
+  return session;
+}
+
+void Session::fillFrame(const GameInfo_t& info, BrickFrame_t& frame) {
+  frame.score = info.score;
+  frame.high_score = info.high_score;
+  frame.level = info.level;
+  frame.speed = info.speed;
+  frame.pause = info.pause;
+  for (int y = 0; y < BRICK_BOARD_HEIGHT; ++y) {
+    for (int x = 0; x < BRICK_BOARD_WIDTH; ++x) {
+      frame.field[y][x] =
+          info.field ? static_cast<int8_t>(info.field[y][x]) : int8_t{0};
+    }
+  }
+  frame.has_next = info.next != nullptr;
+  for (int y = 0; y < BRICK_NEXT_SIZE; ++y) {
+    for (int x = 0; x < BRICK_NEXT_SIZE; ++x) {
+      frame.next[y][x] =
+          info.next ? static_cast<int8_t>(info.next[y][x]) : int8_t{0};
+    }
+  }
+}
+
+}  // namespace s21
@@ -0,0 +1,38 @@
+#ifndef BRICK_SESSION_H
+#define BRICK_SESSION_H
+
+#include <memory>
+
+#include "../brick_game/common.h"
+#include "protocol.h"
+
+namespace s21 {
+
+// Партия одного клиента сервера. Каждая сессия владеет своим состоянием
+// игры (TetrisGame или SnakeGame), поэтому в одном процессе идет любое
+// число партий. Тетрис и змейка живут в отдельных единицах трансляции:
+// их заголовки не рассчитаны на совместное подключение.
+class Session {
+ public:
+  virtual ~Session() = default;
+
+  // Действие клиента
+  virtual void input(UserAction_t action, bool hold) = 0;
+  // Шаг игры по таймеру сервера
+  virtual void tick() = 0;
+  // Текущая картинка; указатели живут до следующего вызова
+  virtual GameInfo_t info() = 0;
+
+  // Новая партия выбранной игры или nullptr для неизвестной игры
+  static std::unique_ptr<Session> create(int game);
+
+  // Переводит GameInfo_t в кадр протокола
+  static void fillFrame(const GameInfo_t& info, BrickFrame_t& frame);
+};
+
+std::unique_ptr<Session> makeTetrisSession();
+std::unique_ptr<Session> makeSnakeSession();
+
+}  // namespace s21
+
+#endif  // BRICK_SESSION_H
@@ -0,0 +1,28 @@
+#include "../brick_game/snake/snake_game.h"
+#include "session.h"
+
+namespace s21 {
+
+namespace {
+
+class SnakeSession : public Session {
+ public:
+  void input(UserAction_t action, bool hold) override {
+    if (!hold) {
+      game_.processInput(action);
+    }
+  }
+  void tick() override { game_.update(); }
+  GameInfo_t info() override { return game_.getGameInfo(); }
+
+ private:
+  SnakeGame game_;
+};
+
+}  // namespace
+
+std::unique_ptr<Session> makeSnakeSession() {
+  return std::make_unique<SnakeSession>();
+}
+
+}  // namespace s21
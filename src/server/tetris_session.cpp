@@ -0,0 +1,31 @@
+#include "../brick_game/tetris/tetris_lib.h"
+#include "session.h"
+
+namespace s21 {
+
+namespace {
+
+class TetrisSession : public Session {
+ public:
+  explicit TetrisSession(TetrisGame* game) : game_(game) {}
+  ~TetrisSession() override { tetris_destroy(game_); }
+
+  // Как и в userInput() тетриса, удержание не отличается от нажатия
+  void input(UserAction_t action, bool) override {
+    tetris_step(game_, action);
+  }
+  void tick() override { tetris_step(game_, Up); }
+  GameInfo_t info() override { return tetris_query(game_); }
+
+ private:
+  TetrisGame* game_;
+};
+
+}  // namespace
+
+std::unique_ptr<Session> makeTetrisSession() {
+  TetrisGame* game = tetris_create();
+  return game ? std::make_unique<TetrisSession>(game) : nullptr;
+}
+
+}  // namespace s21
@@ -0,0 +1,459 @@
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../server/server.h"
+
+namespace s21 {
+
+namespace {
+
+// Клиент протокола brickd поверх блокирующего сокета; ответы читаются без
+// ожидания, пока тест сам прокручивает цикл сервера
+class TestClient {
+ public:
+  explicit TestClient(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, path.c_str());
+    fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    connected_ =
+        connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+  }
+
+  explicit TestClient(int port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<std::uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    connected_ =
+        connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+  }
+
+  ~TestClient() { close(fd_); }
+
+  bool connected() const { return connected_; }
+  bool closed() const { return closed_; }
+
+  void request(int type, int arg, bool hold = false) {
+    BrickRequest_t request{};
+    request.type = static_cast<std::uint8_t>(type);
+    request.arg = static_cast<std::uint8_t>(arg);
+    request.hold = hold;
+    ASSERT_EQ(send(fd_, &request, sizeof(request), 0),
+              static_cast<ssize_t>(sizeof(request)));
+  }
+
+  // Забирает все пришедшие кадры
+  std::vector<BrickFrame_t> frames() {
+    std::uint8_t chunk[4096];
+    ssize_t got = 0;
+    while ((got = recv(fd_, chunk, sizeof(chunk), MSG_DONTWAIT)) > 0) {
+      buffer_.insert(buffer_.end(), chunk, chunk + got);
+    }
+    closed_ = closed_ || got == 0;
+
+    std::vector<BrickFrame_t> result;
+    std::size_t pos = 0;
+    BrickFrameHeader_t header{};
+    bool whole = true;
+    while (whole && buffer_.size() - pos >= sizeof(header)) {
+      std::memcpy(&header, buffer_.data() + pos, sizeof(header));
+      whole = buffer_.size() - pos >= sizeof(header) + header.size;
+      if (whole) {
+        EXPECT_EQ(header.type, Frame_delta);
+        EXPECT_TRUE(decoder_.decode(
+            header.type, buffer_.data() + pos + sizeof(header), header.size));
+        result.push_back(decoder_.frame());
+        pos += sizeof(header) + header.size;
+      }
+    }
+    buffer_.erase(buffer_.begin(), buffer_.begin() + pos);
+    return result;
+  }
+
+ private:
+  int fd_{-1};
+  bool connected_{false};
+  bool closed_{false};
+  std::vector<std::uint8_t> buffer_;
+  FrameDecoder decoder_;
+};
+
+std::string socketPath() {
+  return "/tmp/brickd_test_" + std::to_string(getpid()) + ".sock";
+}
+
+// Прокручивает цикл сервера примерно на duration_ms
+void pump(BrickServer& server, int duration_ms) {
+  for (int i = 0; i < duration_ms; ++i) {
+    server.runOnce(1);
+  }
+}
+
+int filledCells(const BrickFrame_t& frame) {
+  int cells = 0;
+  for (const auto& row : frame.field) {
+    for (std::int8_t cell : row) {
+      cells += cell > 0;
+    }
+  }
+  return cells;
+}
+
+}  // namespace
+
+TEST(BrickServerTest, JoinSendsFirstFrame) {
+  BrickServer server(5);
+  ASSERT_TRUE(server.listenUnix(socketPath()));
+  TestClient tetris(socketPath());
+  TestClient snake(socketPath());
+  ASSERT_TRUE(tetris.connected());
+  ASSERT_TRUE(snake.connected());
+  tetris.request(Request_join, Brick_tetris);
+  snake.request(Request_join, Brick_snake);
+  pump(server, 20);
+  EXPECT_EQ(server.clientCount(), 2u);
+  EXPECT_EQ(server.sessionCount(), 2u);
+
+  auto tetris_frames = tetris.frames();
+  ASSERT_FALSE(tetris_frames.empty());
+  EXPECT_EQ(tetris_frames[0].seq, 1u);
+  EXPECT_TRUE(tetris_frames[0].has_next);
+  auto snake_frames = snake.frames();
+  ASSERT_FALSE(snake_frames.empty());
+  EXPECT_FALSE(snake_frames[0].has_next);
+}
+
+TEST(BrickServerTest, UnchangedSessionSendsNoFrames) {
+  BrickServer server(2);
+  ASSERT_TRUE(server.listenUnix(socketPath()));
+  TestClient client(socketPath());
+  // Змейка до Start стоит на месте: шаги идут, а картинка та же
+  client.request(Request_join, Brick_snake);
+  pump(server, 50);
+  EXPECT_EQ(client.frames().size(), 1u);
+}
+
+TEST(BrickServerTest, InputProducesNewFrames) {
+  BrickServer server(5);
+  ASSERT_TRUE(server.listenUnix(socketPath()));
+  TestClient client(socketPath());
+  client.request(Request_join, Brick_tetris);
+  pump(server, 10);
+  auto before = client.frames();
+  ASSERT_EQ(before.size(), 1u);
+  EXPECT_EQ(filledCells(before[0]), 0);
+
+  client.request(Request_input, Start);
+  client.request(Request_input, Down);
+  pump(server, 20);
+  auto after = client.frames();
+  ASSERT_FALSE(after.empty());
+  EXPECT_EQ(after[0].seq, 2u);
+  // Сброшенная фигура лежит на дне
+  EXPECT_GE(filledCells(after.back()), 4);
+  for (std::size_t i = 1; i < after.size(); ++i) {
+    EXPECT_EQ(after[i].seq, after[i - 1].seq + 1);
+  }
+}
+
+TEST(BrickServerTest, BadRequestClosesConnection) {
+  BrickServer server(5);
+  ASSERT_TRUE(server.listenUnix(socketPath()));
+  TestClient early(socketPath());
+  TestClient unknown(socketPath());
+  TestClient quitting(socketPath());
+  early.request(Request_input, Left);  // Ввод до join
+  unknown.request(Request_join, 7);
+  quitting.request(Request_join, Brick_snake);
+  quitting.request(Request_input, Terminate);
+  pump(server, 20);
+  early.frames();
+  unknown.frames();
+  quitting.frames();
+  EXPECT_TRUE(early.closed());
+  EXPECT_TRUE(unknown.closed());
+  EXPECT_TRUE(quitting.closed());
+  EXPECT_EQ(server.clientCount(), 0u);
+}
+
+TEST(BrickServerTest, ServesManyClientsOverTcp) {
+  BrickServer server(5);
+  ASSERT_TRUE(server.listenTcp(0));
+  ASSERT_GT(server.port(), 0);
+  const int count = 200;
+  std::vector<std::unique_ptr<TestClient>> clients;
+  for (int i = 0; i < count; ++i) {
+    clients.push_back(std::make_unique<TestClient>(server.port()));
+    ASSERT_TRUE(clients.back()->connected());
+    clients.back()->request(Request_join, i % 2 ? Brick_snake : Brick_tetris);
+    clients.back()->request(Request_input, Start);
+    server.runOnce(0);
+  }
+  pump(server, 50);
+  EXPECT_EQ(server.sessionCount(), static_cast<std::size_t>(count));
+  int with_frames = 0;
+  for (auto& client : clients) {
+    with_frames += !client->frames().empty();
+  }
+  EXPECT_EQ(with_frames, count);
+}
+
+TEST(BrickServerTest, SlowReaderKeepsBacklogBounded) {
+  BrickServer server(1);
+  ASSERT_TRUE(server.listenUnix(socketPath()));
+  TestClient client(socketPath());
+  ASSERT_TRUE(client.connected());
+  client.request(Request_join, Brick_tetris);
+  client.request(Request_input, Start);
+
+  // Клиент не читает, а картинка меняется каждый цикл: очередь растет до
+  // предела, дальше кадры пропускаются
+  const UserAction_t moves[] = {Left, Action, Right, Down, Start};
+  std::size_t limit = BrickServer::MAX_BACKLOG + sizeof(BrickFrameHeader_t) +
+                      sizeof(BrickFrame_t);
+  std::size_t peak = 0;
+  int loops = 0;
+  for (; loops < 20000 && peak <= BrickServer::MAX_BACKLOG; ++loops) {
+    client.request(Request_input, moves[loops % 5]);
+    server.runOnce(1);
+    peak = std::max(peak, server.pendingBytes());
+  }
+  ASSERT_GT(peak, BrickServer::MAX_BACKLOG) << "after " << loops << " loops";
+  for (int i = 0; i < 500; ++i) {
+    client.request(Request_input, moves[i % 5]);
+    server.runOnce(1);
+    peak = std::max(peak, server.pendingBytes());
+  }
+  EXPECT_LE(peak, limit);
+
+  // Чтение освобождает сокет, и EPOLLOUT досылает очередь; после
+  // пропущенных кадров разницы продолжают декодироваться по порядку
+  std::vector<BrickFrame_t> frames;
+  for (int i = 0; i < 2000 && server.pendingBytes() > 0; ++i) {
+    auto got = client.frames();
+    frames.insert(frames.end(), got.begin(), got.end());
+    server.runOnce(1);
+  }
+  EXPECT_EQ(server.pendingBytes(), 0u);
+  auto rest = client.frames();
+  frames.insert(frames.end(), rest.begin(), rest.end());
+  ASSERT_FALSE(frames.empty());
+  // Кадр менялся каждый цикл, но на время переполнения кадры не строились
+  EXPECT_LT(frames.size(), static_cast<std::size_t>(loops + 500));
+  for (std::size_t i = 1; i < frames.size(); ++i) {
+    EXPECT_EQ(frames[i].seq, frames[i - 1].seq + 1);
+  }
+
+  // Новая фигура после сброса меняет поле, даже если партия закончилась
+  client.request(Request_input, Start);
+  client.request(Request_input, Down);
+  pump(server, 20);
+  auto after = client.frames();
+  ASSERT_FALSE(after.empty());
+  EXPECT_EQ(after[0].seq, frames.back().seq + 1);
+  EXPECT_FALSE(client.closed());
+}
+
+// Прогоняет поток кадров через кодер и декодер; возвращает байты кадров
+std::vector<std::size_t> roundTrip(FrameEncoder& encoder,
+                                   FrameDecoder& decoder,
+                                   const std::vector<BrickFrame_t>& frames) {
+  std::vector<std::size_t> sizes;
+  for (const BrickFrame_t& frame : frames) {
+    std::vector<std::uint8_t> out;
+    if (encoder.encode(frame, out)) {
+      BrickFrameHeader_t header{};
+      std::memcpy(&header, out.data(), sizeof(header));
+      EXPECT_EQ(out.size(), sizeof(header) + header.size);
+      EXPECT_TRUE(decoder.decode(header.type, out.data() + sizeof(header),
+                                 header.size));
+      BrickFrame_t expected = frame;
+      expected.seq = encoder.seq();
+      EXPECT_EQ(std::memcmp(&decoder.frame(), &expected, sizeof(expected)),
+                0);
+      sizes.push_back(out.size());
+    }
+  }
+  return sizes;
+}
+
+TEST(FrameCodecTest, RandomFramesRoundTrip) {
+  std::mt19937 rng(7);
+  std::vector<BrickFrame_t> frames;
+  BrickFrame_t frame{};
+  for (int i = 0; i < 500; ++i) {
+    // Меняется от одной клетки до всего поля, иногда и поля кадра
+    int changes = i % 50 == 0 ? 200 : static_cast<int>(rng() % 8);
+    for (int c = 0; c < changes; ++c) {
+      frame.field[rng() % 20][rng() % 10] =
+          static_cast<std::int8_t>(static_cast<int>(rng() % 5) - 1);
+    }
+    if (i % 7 == 0) frame.score += 10;
+    if (i % 31 == 0) frame.level++;
+    if (i % 13 == 0) {
+      frame.has_next = 1;
+      frame.next[rng() % 4][rng() % 4] ^= 1;
+    }
+    frame.pause = i % 97 == 0;
+    frames.push_back(frame);
+  }
+  FrameEncoder encoder;
+  FrameDecoder decoder;
+  auto sizes = roundTrip(encoder, decoder, frames);
+  EXPECT_GT(sizes.size(), 400u);
+}
+
+TEST(FrameCodecTest, SnakeStepIsSmall) {
+  auto session = Session::create(Brick_snake);
+  FrameEncoder encoder;
+  FrameDecoder decoder;
+  session->input(Start, false);
+  std::vector<BrickFrame_t> frames;
+  for (int i = 0; i < 40; ++i) {
+    session->tick();
+    BrickFrame_t frame{};
+    Session::fillFrame(session->info(), frame);
+    frames.push_back(frame);
+  }
+  auto sizes = roundTrip(encoder, decoder, frames);
+  ASSERT_GT(sizes.size(), 1u);
+  // Первый кадр опорный, дальше голова и хвост змейки
+  EXPECT_LT(sizes[0], sizeof(BrickFrameHeader_t) + sizeof(BrickFrame_t));
+  for (std::size_t i = 1; i < sizes.size(); ++i) {
+    EXPECT_LE(sizes[i], 24u);
+  }
+}
+
+TEST(FrameCodecTest, UnchangedFrameIsSkipped) {
+  FrameEncoder encoder;
+  BrickFrame_t frame{};
+  frame.score = 5;
+  std::vector<std::uint8_t> out;
+  EXPECT_TRUE(encoder.encode(frame, out));
+  std::size_t size = out.size();
+  EXPECT_FALSE(encoder.encode(frame, out));
+  EXPECT_EQ(out.size(), size);
+  EXPECT_EQ(encoder.seq(), 1u);
+
+  // Запрошенный опорный кадр уходит и без изменений
+  encoder.requestKeyframe();
+  EXPECT_TRUE(encoder.encode(frame, out));
+  EXPECT_EQ(out.size(), 2 * size);
+}
+
+TEST(FrameCodecTest, EncodesIntoCallerBuffer) {
+  auto session = Session::create(Brick_tetris);
+  session->input(Start, false);
+  FrameEncoder encoder;
+  FrameDecoder decoder;
+  std::vector<std::uint8_t> out;
+  out.reserve(4096);
+  const std::uint8_t* data = out.data();
+  for (int i = 0; i < 200; ++i) {
+    session->input(i % 3 ? Left : Down, false);
+    session->tick();
+    out.clear();
+    if (encoder.encode(session->info(), out)) {
+      BrickFrameHeader_t header{};
+      std::memcpy(&header, out.data(), sizeof(header));
+      ASSERT_EQ(out.size(), sizeof(header) + header.size);
+      EXPECT_TRUE(decoder.decode(header.type, out.data() + sizeof(header),
+                                 header.size));
+    } else {
+      EXPECT_TRUE(out.empty());
+    }
+  }
+  // Кадры пишутся прямо в буфер вызывающего, он не перевыделяется
+  EXPECT_EQ(out.data(), data);
+  EXPECT_EQ(decoder.frame().seq, encoder.seq());
+}
+
+TEST(FrameCodecTest, KeyframesRepeat) {
+  FrameEncoder encoder(4);
+  BrickFrame_t frame{};
+  std::vector<bool> keys;
+  for (int i = 0; i < 9; ++i) {
+    frame.score = i;
+    std::vector<std::uint8_t> out;
+    ASSERT_TRUE(encoder.encode(frame, out));
+    std::uint8_t flags = out[sizeof(BrickFrameHeader_t) + 4];
+    keys.push_back(flags & Delta_key);
+  }
+  std::vector<bool> expected = {true,  false, false, false, true,
+                                false, false, false, true};
+  EXPECT_EQ(keys, expected);
+}
+
+TEST(FrameCodecTest, DecoderWaitsForKeyframeAfterGap) {
+  FrameEncoder encoder(3);
+  FrameDecoder decoder;
+  BrickFrame_t frame{};
+  std::vector<std::vector<std::uint8_t>> stream;
+  for (int i = 0; i < 6; ++i) {
+    frame.field[i][i] = 1;
+    stream.emplace_back();
+    ASSERT_TRUE(encoder.encode(frame, stream.back()));
+  }
+  auto apply = [&](const std::vector<std::uint8_t>& bytes) {
+    BrickFrameHeader_t header{};
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    return decoder.decode(header.type, bytes.data() + sizeof(header),
+                          header.size);
+  };
+  // Разница без опорного кадра не применяется
+  EXPECT_FALSE(apply(stream[1]));
+  EXPECT_TRUE(apply(stream[0]));
+  EXPECT_FALSE(apply(stream[2]));  // Пропущен кадр 2
+  EXPECT_FALSE(decoder.ready());
+  EXPECT_TRUE(apply(stream[3]));  // Опорный кадр 4
+  EXPECT_TRUE(apply(stream[4]));
+  EXPECT_EQ(decoder.frame().seq, 5u);
+  EXPECT_EQ(decoder.frame().field[4][4], 1);
+}
+
+TEST(FrameCodecTest, RejectsDamagedFrames) {
+  FrameEncoder encoder;
+  FrameDecoder decoder;
+  BrickFrame_t frame{};
+  frame.field[19][9] = CELL_GHOST;
+  std::vector<std::uint8_t> out;
+  ASSERT_TRUE(encoder.encode(frame, out));
+  const std::uint8_t* body = out.data() + sizeof(BrickFrameHeader_t);
+  std::size_t size = out.size() - sizeof(BrickFrameHeader_t);
+  EXPECT_FALSE(decoder.decode(Frame_delta, body, size - 1));
+  EXPECT_FALSE(decoder.decode(Frame_delta, body, 3));
+  EXPECT_FALSE(decoder.decode(Frame_full, body, size));
+  EXPECT_FALSE(decoder.decode(7, body, size));
+
+  std::vector<std::uint8_t> longer(body, body + size);
+  longer.push_back(0);
+  EXPECT_FALSE(decoder.decode(Frame_delta, longer.data(), longer.size()));
+
+  ASSERT_TRUE(decoder.decode(Frame_delta, body, size));
+  EXPECT_EQ(decoder.frame().field[19][9], CELL_GHOST);
+
+  // Отрезок за пределами поля
+  frame.field[0][0] = 1;
+  out.clear();
+  ASSERT_TRUE(encoder.encode(frame, out));
+  std::vector<std::uint8_t> broken(out.begin() + sizeof(BrickFrameHeader_t),
+                                   out.end());
+  std::size_t run = broken.size() - 3;  // first, length, одна пара клеток
+  broken[run] = 199;
+  broken[run + 1] = 2;
+  EXPECT_FALSE(decoder.decode(Frame_delta, broken.data(), broken.size()));
+}
+
+}  // namespace s21
@@ -4,12 +4,15 @@
 #include <filesystem>
 #include <fstream>
 #include <thread>
+#include <type_traits>
 
 #include "../brick_game/controller.h"
 #include "../brick_game/snake/apple.h"
+#include "../brick_game/snake/autopilot.h"
 #include "../brick_game/snake/field.h"
 #include "../brick_game/snake/point.h"
 #include "../brick_game/snake/snake.h"
+#include "../brick_game/snake/snake_body.h"
 #include "../brick_game/snake/snake_game.h"
 #include "../brick_game/snake/states/game_over_state.h"
 #include "../brick_game/snake/states/idle_state.h"
@@ -154,6 +157,58 @@ TEST(FieldTest, Clear) {
   }
 }
 
+TEST(FieldTest, DirtyCells) {
+  Field field;
+  EXPECT_TRUE(field.isFullyDirty());
+
+  field.clearDirty();
+  EXPECT_FALSE(field.isFullyDirty());
+  EXPECT_TRUE(field.getDirtyCells().empty());
+
+  field.setCell(1, 2, Field::SNAKE);
+  field.setCell(1, 2, Field::SNAKE);  // значение не изменилось
+  field.setCell(3, 4, Field::APPLE);
+  field.setCell(-1, 4, Field::APPLE);  // за границей
+  ASSERT_EQ(field.getDirtyCells().size(), 2u);
+  EXPECT_EQ(field.getDirtyCells()[0], Point(1, 2));
+  EXPECT_EQ(field.getDirtyCells()[1], Point(3, 4));
+
+  field.clear();
+  EXPECT_TRUE(field.isFullyDirty());
+  EXPECT_TRUE(field.getDirtyCells().empty());
+}
+
+TEST(FieldTest, DirtyCellsOverflow) {
+  Field field;
+  field.clearDirty();
+  for (int x = 0; x <= Field::DIRTY_CAPACITY; ++x) {
+    field.setCell(x % Field::WIDTH, x / Field::WIDTH, Field::SNAKE);
+  }
+  EXPECT_TRUE(field.isFullyDirty());
+  EXPECT_TRUE(field.getDirtyCells().empty());
+}
+
+TEST(FieldTest, FreeCellIndex) {
+  Field field;
+  EXPECT_EQ(field.getFreeCount(), Field::CELLS);
+
+  field.setCell(2, 3, Field::SNAKE);
+  field.setCell(4, 5, Field::APPLE);
+  field.setCell(4, 5, Field::SNAKE);  // занятая клетка остается занятой
+  EXPECT_EQ(field.getFreeCount(), Field::CELLS - 2);
+
+  for (int i = 0; i < field.getFreeCount(); ++i) {
+    Point p = field.getFreeCell(i);
+    EXPECT_TRUE(field.isEmpty(p));
+  }
+
+  field.setCell(2, 3, Field::EMPTY);
+  EXPECT_EQ(field.getFreeCount(), Field::CELLS - 1);
+
+  field.clear();
+  EXPECT_EQ(field.getFreeCount(), Field::CELLS);
+}
+
 // Тесты для класса Snake
 TEST(SnakeTest, DefaultConstructor) {
   Snake snake;
@@ -306,6 +361,82 @@ TEST(SnakeTest, Clear) {
   EXPECT_TRUE(snake.getBody().empty());
 }
 
+TEST(SnakeTest, ContainsFollowsMoves) {
+  Snake snake;
+  snake.initialize(Point(5, 5));
+
+  snake.move(false);
+  EXPECT_TRUE(snake.contains(Point(6, 5)));
+  EXPECT_TRUE(snake.contains(Point(4, 5)));
+  // Бывший хвост освобожден, новый хвост не учитывается
+  EXPECT_FALSE(snake.contains(Point(2, 5)));
+  EXPECT_FALSE(snake.contains(Point(3, 5)));
+
+  snake.move(true);
+  EXPECT_TRUE(snake.contains(Point(7, 5)));
+  EXPECT_EQ(snake.getLength(), 5);
+
+  EXPECT_FALSE(snake.contains(Point(-1, 5)));
+  EXPECT_FALSE(snake.contains(Point(5, Field::HEIGHT)));
+
+  snake.clear();
+  EXPECT_FALSE(snake.contains(Point(7, 5)));
+}
+
+TEST(SnakeTest, MoveIntoVacatedTail) {
+  Snake snake;
+  snake.initialize(Point(5, 5));
+  snake.setDirection(Snake::Direction::UP);
+  snake.move(false);  // (5,4) (5,5) (4,5) (3,5)
+  snake.setDirection(Snake::Direction::LEFT);
+  snake.move(false);  // (4,4) (5,4) (5,5) (4,5)
+  snake.setDirection(Snake::Direction::DOWN);
+
+  // Голова входит в клетку, которую одновременно покидает хвост
+  EXPECT_TRUE(snake.move(false));
+  EXPECT_EQ(snake.getHead(), Point(4, 5));
+  EXPECT_TRUE(snake.contains(Point(4, 5)));
+  EXPECT_TRUE(snake.contains(Point(4, 4)));
+}
+
+// Тесты для кольцевого буфера тела змейки
+TEST(SnakeBodyTest, PushAndPop) {
+  SnakeBody body;
+  EXPECT_TRUE(body.empty());
+
+  body.pushFront(Point(1, 2));
+  body.pushFront(Point(-1, 20));
+  ASSERT_EQ(body.size(), 2u);
+  EXPECT_EQ(body.front(), Point(-1, 20));
+  EXPECT_EQ(body.back(), Point(1, 2));
+
+  body.popBack();
+  EXPECT_EQ(body.size(), 1u);
+  EXPECT_EQ(body.back(), Point(-1, 20));
+
+  body.clear();
+  EXPECT_TRUE(body.empty());
+}
+
+TEST(SnakeBodyTest, WrapsAround) {
+  SnakeBody body;
+  // Много ходов без роста: голова многократно обходит весь буфер
+  for (int i = 0; i < SnakeBody::CAPACITY * 3; ++i) {
+    body.pushFront(
+        Point(i % Field::WIDTH, (i / Field::WIDTH) % Field::HEIGHT));
+    if (body.size() > 4) body.popBack();
+  }
+  ASSERT_EQ(body.size(), 4u);
+  int last = SnakeBody::CAPACITY * 3 - 1;
+  int i = 0;
+  for (const auto& segment : body) {
+    int n = last - i++;
+    EXPECT_EQ(segment,
+              Point(n % Field::WIDTH, (n / Field::WIDTH) % Field::HEIGHT));
+  }
+  EXPECT_EQ(i, 4);
+}
+
 // Тесты для класса Apple
 TEST(AppleTest, SpawnOnEmptyField) {
   Field field;
@@ -347,11 +478,50 @@ TEST(AppleTest, SpawnOnFullField) {
   // Добавляем больше сегментов, чтобы заполнить все поле
   // (в реальности это невозможно, но тестируем edge case)
 
-  // В этом случае apple.spawn должен вернуть Point(0, 0)
-  apple.spawn(field, snake);
+  // Свободных клеток нет: яблоко убирается за пределы поля
+  EXPECT_FALSE(apple.spawn(field, snake));
 
   const Point& pos = apple.getPosition();
-  EXPECT_EQ(pos, Point(0, 0));
+  EXPECT_FALSE(field.isInside(pos));
+}
+
+TEST(AppleTest, SpawnOnLastFreeCell) {
+  Field field;
+  Snake snake;
+  Apple apple;
+
+  for (int y = 0; y < Field::HEIGHT; ++y) {
+    for (int x = 0; x < Field::WIDTH; ++x) {
+      field.setCell(x, y, Field::SNAKE);
+    }
+  }
+  field.setCell(7, 13, Field::EMPTY);
+
+  EXPECT_TRUE(apple.spawn(field, snake));
+  EXPECT_EQ(apple.getPosition(), Point(7, 13));
+}
+
+TEST(AppleTest, SpawnSkipsUnpaintedSnake) {
+  Field field;
+  Snake snake;
+  Apple apple;
+
+  // Змейка не отрисована на поле, свободна только одна клетка вне ее
+  snake.initialize(Point(3, 0));
+  for (int y = 1; y < Field::HEIGHT; ++y) {
+    for (int x = 0; x < Field::WIDTH; ++x) {
+      field.setCell(x, y, Field::SNAKE);
+    }
+  }
+  for (int x = 4; x < Field::WIDTH; ++x) {
+    field.setCell(x, 0, Field::SNAKE);
+  }
+
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_TRUE(apple.spawn(field, snake));
+    // (0,0) - хвост, он не учитывается в contains()
+    EXPECT_FALSE(snake.contains(apple.getPosition()));
+  }
 }
 
 // Тесты для класса SnakeGame
@@ -359,11 +529,13 @@ class SnakeGameTest : public ::testing::Test {
  protected:
   void SetUp() override {
     // Удаляем файл с рекордом перед каждым тестом
+    highscore_reset();
     std::remove("snake_highscore.dat");
   }
 
   void TearDown() override {
     // Очищаем после теста
+    highscore_reset();
     std::remove("snake_highscore.dat");
   }
 
@@ -872,6 +1044,9 @@ TEST_F(PlayingStateTest, HandleInput_DirectionChanges) {
 // Тест 2: Проверка обработки ввода Pause
 TEST_F(PlayingStateTest, HandleInput_Pause_ChangesToPausedState) {
   state_->handleInput(*game_, UserAction_t::Start);
+  // Рекорд не меньше стартового счета: раньше его подтягивал файл,
+  // оставшийся от предыдущих тестов
+  game_->updateHighScore();
   // Сохраняем начальное состояние
   auto initial_score = game_->getHighScore();
 
@@ -1073,6 +1248,37 @@ TEST_F(PlayingStateTest, Update_FieldUpdated) {
   EXPECT_EQ(cell_after, Field::SNAKE);
 }
 
+// Тест 11а: Поле обновляется только в клетках головы и хвоста
+TEST_F(PlayingStateTest, Update_IncrementalField) {
+  auto& field = game_->getField();
+  auto& snake = game_->getSnake();
+  game_->getApple().setPosition(Point(0, 0));
+  field.clearDirty();
+
+  Point tail_before = snake.getBody().back();
+  int delay = 20 - game_->getSpeed();
+  for (int i = 0; i < delay; ++i) {
+    state_->update(*game_);
+  }
+
+  const Point& head = snake.getHead();
+  EXPECT_EQ(field.getCell(head.x, head.y), Field::SNAKE);
+  EXPECT_EQ(field.getCell(tail_before.x, tail_before.y), Field::EMPTY);
+  EXPECT_FALSE(field.isFullyDirty());
+  ASSERT_EQ(field.getDirtyCells().size(), 2u);
+  EXPECT_EQ(field.getDirtyCells()[0], tail_before);
+  EXPECT_EQ(field.getDirtyCells()[1], head);
+
+  // Поле совпадает с полной перерисовкой
+  int snake_cells = 0;
+  for (const auto& row : field.getGrid()) {
+    for (auto cell : row) {
+      snake_cells += cell == Field::SNAKE;
+    }
+  }
+  EXPECT_EQ(snake_cells, static_cast<int>(snake.getLength()));
+}
+
 // Тест 12: Проверка валидности смены направления
 TEST_F(PlayingStateTest, DirectionChange_Validity) {
   auto& snake = game_->getSnake();
@@ -1110,6 +1316,7 @@ class SnakeGameTest2 : public ::testing::Test {
  protected:
   void SetUp() override {
     // Удаляем файл рекорда перед тестом
+    highscore_reset();
     std::filesystem::remove("snake_highscore.dat");
     game_ = std::make_unique<SnakeGame>();
   }
@@ -1117,6 +1324,7 @@ class SnakeGameTest2 : public ::testing::Test {
   void TearDown() override {
     game_.reset();
     // Удаляем файл рекорда после теста
+    highscore_reset();
     std::filesystem::remove("snake_highscore.dat");
   }
 
@@ -1230,6 +1438,8 @@ TEST_F(SnakeGameTest2, UpdateHighScore_UpdatesWhenHigher) {
 
 // Тест 7: Проверка сохранения и загрузки рекорда
 TEST_F(SnakeGameTest2, SaveAndLoadHighScore_PersistsBetweenInstances) {
+  // Рекорд сохраняет только партия игрока
+  game_ = std::make_unique<SnakeGame>(true);
   // Устанавливаем рекорд
   game_->addScore(100);
   game_->updateHighScore();
@@ -1394,6 +1604,63 @@ TEST_F(SnakeGameTest2, LoadHighScore_NoFile_CreatesDefault) {
   EXPECT_EQ(game_->getHighScore(), 0);
 }
 
+// Тест 16а: Снимок поля общий для всех состояний и обновляется по версии
+TEST_F(SnakeGameTest2, GameInfo_SharedSnapshot) {
+  game_->start();
+  GameInfo_t playing = PlayingState().getGameInfo(*game_);
+  GameInfo_t paused = PausedState().getGameInfo(*game_);
+  EXPECT_EQ(playing.field, paused.field);
+  EXPECT_EQ(paused.pause, 1);
+
+  auto version = game_->getFieldVersion();
+  GameInfo_t again = game_->getGameInfo();
+  EXPECT_EQ(game_->getFieldVersion(), version);
+  EXPECT_EQ(again.field, playing.field);
+
+  const Point& head = game_->getSnake().getHead();
+  EXPECT_EQ(again.field[head.y][head.x], Field::SNAKE);
+
+  game_->getField().setCell(0, 0, Field::WALL);
+  EXPECT_GT(game_->getFieldVersion(), version);
+  GameInfo_t changed = game_->getGameInfo();
+  EXPECT_EQ(changed.field[0][0], Field::WALL);
+}
+
+// Снимок поля указывает внутрь объекта игры, перенос сломал бы указатели
+static_assert(!std::is_copy_constructible_v<SnakeGame>);
+static_assert(!std::is_move_constructible_v<SnakeGame>);
+static_assert(!std::is_move_assignable_v<SnakeGame>);
+
+// Тест 16б: Снимок копирует только измененные клетки и сбрасывает список
+TEST_F(SnakeGameTest2, GameInfo_CopiesDirtyCells) {
+  game_->start();
+  GameInfo_t info = game_->getGameInfo();
+  const Field& field = game_->getField();
+  EXPECT_FALSE(field.isFullyDirty());
+  EXPECT_TRUE(field.getDirtyCells().empty());
+
+  for (int tick = 0; tick < 200 && !game_->isOver(); ++tick) {
+    game_->update();
+    info = game_->getGameInfo();
+    EXPECT_TRUE(field.getDirtyCells().empty());
+    for (int y = 0; y < Field::HEIGHT; ++y) {
+      for (int x = 0; x < Field::WIDTH; ++x) {
+        ASSERT_EQ(info.field[y][x], static_cast<int>(field.getCell(x, y)))
+            << "tick " << tick << " cell " << x << "," << y;
+      }
+    }
+  }
+
+  // Новая партия очищает поле целиком: снимок переписывается весь
+  game_->start();
+  info = game_->getGameInfo();
+  for (int y = 0; y < Field::HEIGHT; ++y) {
+    for (int x = 0; x < Field::WIDTH; ++x) {
+      ASSERT_EQ(info.field[y][x], static_cast<int>(field.getCell(x, y)));
+    }
+  }
+}
+
 // Тест 17: Проверка корректности констант
 TEST_F(SnakeGameTest2, Constants_HaveCorrectValues) {
   EXPECT_EQ(SnakeGame::MAX_SNAKE_LENGTH, 200);
@@ -1404,6 +1671,217 @@ TEST_F(SnakeGameTest2, Constants_HaveCorrectValues) {
   EXPECT_EQ(SnakeGame::SPEED_INCREMENT, 2);
 }
 
+// Тесты автопилота
+TEST(AutopilotTest, HeadsForApple) {
+  SnakeGame game;
+  game.start();
+  Autopilot pilot;
+  const Point head = game.getSnake().getHead();
+
+  game.getApple().setPosition(Point(head.x + 3, head.y));
+  EXPECT_EQ(pilot.decide(game), Right);
+  game.getApple().setPosition(Point(head.x, head.y - 4));
+  EXPECT_EQ(pilot.decide(game), Up);
+  // Яблоко позади головы: разворот невозможен, путь идет в обход
+  game.getApple().setPosition(Point(head.x - 5, head.y));
+  UserAction_t action = pilot.decide(game);
+  EXPECT_TRUE(action == Up || action == Down);
+}
+
+TEST(AutopilotTest, SafeMoveWithoutApple) {
+  SnakeGame game;
+  game.start();
+  Autopilot pilot;
+  game.getApple().setPosition(Point(-1, -1));
+  // Змейка у правой стены: вправо нельзя, выбирается безопасный поворот
+  Snake& snake = game.getSnake();
+  snake.initialize(Point(Field::WIDTH - 1, 0));
+  EXPECT_EQ(pilot.chooseDirection(snake, Point(-1, -1)),
+            Snake::Direction::DOWN);
+}
+
+TEST(AutopilotTest, PlaysWholeGames) {
+  Autopilot pilot;
+  SnakeGame game;
+  for (int i = 0; i < 5; ++i) {
+    // Змейка может бесконечно ходить за хвостом, поэтому ходы ограничены
+    int moves = pilot.playGame(game, 20000);
+    EXPECT_GT(moves, 0);
+    EXPECT_GT(game.getScore(), 20);
+    EXPECT_TRUE(game.isOver() || moves == 20000);
+  }
+  highscore_reset();
+  std::filesystem::remove("snake_highscore.dat");
+}
+
+// Тесты записи партий
+namespace {
+
+// Партия автопилота через processInput(), как ее вел бы фронтенд
+void playRecorded(SnakeGame& game, int moves) {
+  Autopilot pilot;
+  game.processInput(Start);
+  for (int i = 0; i < moves && !game.isOver(); ++i) {
+    game.processInput(pilot.decide(game));
+    std::uint64_t version = game.getFieldVersion();
+    while (game.getFieldVersion() == version && !game.isOver()) {
+      game.update();
+    }
+  }
+}
+
+}  // namespace
+
+TEST(SnakeReplayTest, SeedFixesApples) {
+  SnakeGame first;
+  SnakeGame second;
+  first.seed(7);
+  second.seed(7);
+  first.start();
+  second.start();
+  EXPECT_EQ(first.getApple().getPosition(), second.getApple().getPosition());
+}
+
+TEST(SnakeReplayTest, PlaybackMatchesRecording) {
+  Replay_t replay;
+  SnakeGame game;
+  game.seed(2024);
+  game.record(&replay);
+  playRecorded(game, 400);
+  game.processInput(Pause);
+  game.update();
+  game.stopRecording();
+  EXPECT_GT(replay.score, 4);
+  EXPECT_GT(replay.events, 100);
+
+  ReplayResult_t result;
+  EXPECT_TRUE(SnakeGame::playReplay(replay, result));
+  EXPECT_EQ(result.score, replay.score);
+  EXPECT_EQ(result.ticks, replay.ticks);
+
+  // Другое зерно - другие яблоки и другой итог
+  replay.seed = 2025;
+  EXPECT_FALSE(SnakeGame::playReplay(replay, result));
+  replay_free(&replay);
+  highscore_reset();
+  std::filesystem::remove("snake_highscore.dat");
+}
+
+TEST(SnakeReplayTest, SaveAndLoad) {
+  Replay_t replay;
+  SnakeGame game;
+  game.seed(5);
+  game.record(&replay);
+  playRecorded(game, 100);
+  game.stopRecording();
+  ASSERT_TRUE(replay_save(&replay, "snake_test.rpl"));
+
+  Replay_t loaded;
+  ASSERT_TRUE(replay_load(&loaded, "snake_test.rpl"));
+  EXPECT_EQ(loaded.game, Replay_snake);
+  EXPECT_EQ(loaded.seed, 5u);
+  EXPECT_EQ(loaded.events, replay.events);
+  EXPECT_EQ(loaded.size, replay.size);
+  ReplayResult_t result;
+  EXPECT_TRUE(SnakeGame::playReplay(loaded, result));
+  // Запись тетриса змейкой не воспроизводится
+  loaded.game = Replay_tetris;
+  EXPECT_FALSE(SnakeGame::playReplay(loaded, result));
+
+  replay_free(&replay);
+  replay_free(&loaded);
+  std::filesystem::remove("snake_test.rpl");
+  highscore_reset();
+  std::filesystem::remove("snake_highscore.dat");
+}
+
+namespace {
+
+int readScoreFile(const char* path) {
+  int score = -1;
+  std::ifstream file(path, std::ios::binary);
+  file.read(reinterpret_cast<char*>(&score), sizeof(score));
+  return file ? score : -1;
+}
+
+}  // namespace
+
+TEST(HighScoreStoreTest, CoalescesRecordsUntilFlush) {
+  highscore_reset();
+  std::filesystem::remove("store_test.dat");
+  EXPECT_EQ(highscore_load("store_test.dat"), 0);
+
+  highscore_submit("store_test.dat", 10);
+  highscore_submit("store_test.dat", 30);
+  highscore_submit("store_test.dat", 20);  // Меньше рекорда - не учитывается
+  EXPECT_EQ(highscore_load("store_test.dat"), 30);
+  // Фоновый поток еще ждет, файл не тронут
+  EXPECT_EQ(readScoreFile("store_test.dat"), -1);
+
+  highscore_flush();
+  EXPECT_EQ(readScoreFile("store_test.dat"), 30);
+  highscore_reset();
+  std::filesystem::remove("store_test.dat");
+}
+
+TEST(HighScoreStoreTest, ReadsFileOnlyOnce) {
+  highscore_reset();
+  {
+    std::ofstream file("store_test.dat", std::ios::binary);
+    int score = 7;
+    file.write(reinterpret_cast<const char*>(&score), sizeof(score));
+  }
+  EXPECT_EQ(highscore_load("store_test.dat"), 7);
+  std::filesystem::remove("store_test.dat");
+  EXPECT_EQ(highscore_load("store_test.dat"), 7);
+  highscore_reset();
+  EXPECT_EQ(highscore_load("store_test.dat"), 0);
+  highscore_reset();
+}
+
+TEST(HighScoreStoreTest, WriterFlushesOnTimer) {
+  highscore_reset();
+  std::filesystem::remove("store_test.dat");
+  highscore_submit("store_test.dat", 42);
+  int score = -1;
+  for (int i = 0; i < 100 && score != 42; ++i) {
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(HIGHSCORE_FLUSH_MS / 20));
+    score = readScoreFile("store_test.dat");
+  }
+  EXPECT_EQ(score, 42);
+  highscore_reset();
+  std::filesystem::remove("store_test.dat");
+}
+
+TEST(HighScoreStoreTest, OnlyPlayerGameSavesResults) {
+  highscore_reset();
+  std::filesystem::remove("snake_highscore.dat");
+  std::filesystem::remove(LEADERBOARD_FILE);
+
+  SnakeGame bot;
+  bot.start();
+  bot.addScore(50);
+  bot.finish();
+  highscore_flush();
+  EXPECT_EQ(bot.getHighScore(), 54);
+  EXPECT_FALSE(std::filesystem::exists("snake_highscore.dat"));
+  EXPECT_FALSE(std::filesystem::exists(LEADERBOARD_FILE));
+
+  SnakeGame player(true);
+  player.start();
+  player.addScore(50);
+  player.finish();
+  highscore_flush();
+  EXPECT_EQ(readScoreFile("snake_highscore.dat"), 54);
+  EXPECT_TRUE(std::filesystem::exists(LEADERBOARD_FILE));
+
+  highscore_reset();
+  std::filesystem::remove("snake_highscore.dat");
+  std::filesystem::remove(LEADERBOARD_FILE);
+  std::filesystem::remove(LEADERBOARD_FILE ".lock");
+}
+
 }  // namespace s21
 
 int main(int argc, char** argv) {
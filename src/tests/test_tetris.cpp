@@ -0,0 +1,1241 @@
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../brick_game/highscore.h"
+#include "../brick_game/leaderboard.h"
+#include "../brick_game/tetris/tetris_autoplay.h"
+#include "../brick_game/tetris/tetris_lib.h"
+#include "../brick_game/tetris/tetris_placement.h"
+#include "../brick_game/tetris/thread_pool.h"
+
+namespace {
+
+// Пустое поле со стенками, как после start_init()
+Game_intro emptyGame() {
+  Game_intro val{};
+  for (int y = 0; y < FIELD_HEIGHT; ++y) {
+    val.field[y] = WALL_MASK;
+  }
+  return val;
+}
+
+void setCell(Game_intro& val, int x, int y) {
+  val.field[y] |= static_cast<uint16_t>(1u << (x + ROW_SHIFT));
+}
+
+bool getCell(const Game_intro& val, int x, int y) {
+  return (val.field[y] >> (x + ROW_SHIFT)) & 1u;
+}
+
+// Сбрасывает кэш рекордов до удаления файла, иначе фоновый поток при
+// выходе снова создаст его
+void removeHighScore() {
+  highscore_reset();
+  std::remove("highscore.dat");
+}
+
+}  // namespace
+
+// Тесты битового представления поля
+TEST(TetrisBitboardTest, DelFullLine_TwoLines) {
+  Game_intro val = emptyGame();
+  for (int x = 0; x < FIELD_WIDTH; ++x) {
+    setCell(val, x, 18);
+    setCell(val, x, 19);
+  }
+  setCell(val, 3, 17);
+
+  EXPECT_EQ(del_full_line(&val), 300);
+  EXPECT_TRUE(getCell(val, 3, 19));
+  for (int y = 0; y < 19; ++y) {
+    EXPECT_EQ(val.field[y], WALL_MASK);
+  }
+}
+
+TEST(TetrisBitboardTest, DelFullLine_KeepsRowsOrder) {
+  Game_intro val = emptyGame();
+  for (int x = 0; x < FIELD_WIDTH; ++x) {
+    setCell(val, x, 17);
+  }
+  setCell(val, 1, 16);
+  setCell(val, 2, 18);
+
+  EXPECT_EQ(del_full_line(&val), 100);
+  EXPECT_TRUE(getCell(val, 1, 17));
+  EXPECT_TRUE(getCell(val, 2, 18));
+  EXPECT_EQ(val.field[16], WALL_MASK);
+}
+
+TEST(TetrisBitboardTest, DelFullLine_ZeroInitializedField) {
+  Game_intro val{};
+  for (int x = 0; x < FIELD_WIDTH; ++x) {
+    setCell(val, x, 19);
+  }
+  EXPECT_EQ(del_full_line(&val), 100);
+}
+
+TEST(TetrisBitboardTest, Check_Walls) {
+  Game_intro val = emptyGame();
+  init_figure(&val, 0);  // I, горизонтальная в строке 2
+  val.fig = val.next_fig;
+  val.fig.y = 5;
+
+  val.fig.x = 0;
+  EXPECT_EQ(check(&val), 1);
+  val.fig.x = -1;
+  EXPECT_EQ(check(&val), 0);
+  val.fig.x = 6;
+  EXPECT_EQ(check(&val), 1);
+  val.fig.x = 7;
+  EXPECT_EQ(check(&val), 0);
+  val.fig.x = 40;
+  EXPECT_EQ(check(&val), 0);
+}
+
+TEST(TetrisBitboardTest, Check_FloorAndBlocks) {
+  Game_intro val = emptyGame();
+  init_figure(&val, 3);  // квадрат в строках 1-2, столбцах 1-2
+  val.fig = val.next_fig;
+  val.fig.x = 0;
+
+  val.fig.y = 17;
+  EXPECT_EQ(check(&val), 1);
+  EXPECT_EQ(check_y(&val), 1);
+  val.fig.y = 18;
+  EXPECT_EQ(check(&val), 0);
+
+  val.fig.y = 10;
+  setCell(val, 2, 12);
+  EXPECT_EQ(check(&val), 0);
+  EXPECT_EQ(check_left(&val), 1);
+  val.fig.x = 2;
+  EXPECT_EQ(check(&val), 1);
+  EXPECT_EQ(check_left(&val), 0);
+}
+
+TEST(TetrisBitboardTest, Rotate_IBecomesVertical) {
+  Game_intro val = emptyGame();
+  init_figure(&val, 0);
+  Figure_t fig = val.next_fig;
+  rotate(&fig);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(fig.rows[i], 0x2);
+  }
+  rotate(&fig);
+  rotate(&fig);
+  rotate(&fig);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(fig.rows[i], val.next_fig.rows[i]);
+  }
+}
+
+TEST(TetrisBitboardTest, PieceTable_MatchesMatrixRotation) {
+  for (int piece = 0; piece < PIECE_COUNT; ++piece) {
+    for (int r = 0; r < 4; ++r) {
+      const PieceShape_t& shape = PIECE_SHAPES[piece][r];
+      const PieceShape_t& next = PIECE_SHAPES[piece][(r + 1) & 3];
+      int left = 4, right = -1, top = 4, bottom = -1;
+      int floor[4] = {-1, -1, -1, -1};
+      for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+          // Клетка [i][j] после поворота берется из [3 - j][i]
+          EXPECT_EQ((next.rows[i] >> j) & 1, (shape.rows[3 - j] >> i) & 1);
+          if ((shape.rows[i] >> j) & 1) {
+            left = std::min(left, j);
+            right = std::max(right, j);
+            top = std::min(top, i);
+            bottom = std::max(bottom, i);
+            floor[j] = i;
+          }
+        }
+      }
+      EXPECT_EQ(shape.left, left);
+      EXPECT_EQ(shape.right, right);
+      EXPECT_EQ(shape.top, top);
+      EXPECT_EQ(shape.bottom, bottom);
+      for (int j = 0; j < 4; ++j) {
+        EXPECT_EQ(shape.floor[j], floor[j]);
+      }
+    }
+  }
+}
+
+TEST(TetrisBitboardTest, Endval_LocksFigureAndClearsLine) {
+  Game_intro val = emptyGame();
+  for (int x = 4; x < FIELD_WIDTH; ++x) {
+    setCell(val, x, 19);
+  }
+  init_figure(&val, 0);
+  val.fig = val.next_fig;
+  val.fig.x = 0;
+  val.fig.y = 17;  // строка 2 фигуры ложится в строку 19
+
+  EXPECT_EQ(endval(&val), 100);
+  for (int y = 0; y < FIELD_HEIGHT; ++y) {
+    EXPECT_EQ(val.field[y], WALL_MASK);
+  }
+}
+
+TEST(TetrisBitboardTest, ColumnHeights) {
+  Game_intro val = emptyGame();
+  setCell(val, 0, 19);
+  setCell(val, 3, 12);
+  setCell(val, 3, 18);
+  setCell(val, 9, 0);
+
+  int heights[FIELD_WIDTH];
+  column_heights(val.field, heights);
+  EXPECT_EQ(heights[0], 1);
+  EXPECT_EQ(heights[1], 0);
+  EXPECT_EQ(heights[3], 8);
+  EXPECT_EQ(heights[9], FIELD_HEIGHT);
+}
+
+TEST(TetrisBitboardTest, DropRow_MatchesStepping) {
+  // Случайные поля с навесами: результат совпадает с построчным спуском
+  srand(7);
+  for (int round = 0; round < 200; ++round) {
+    Game_intro val = emptyGame();
+    for (int y = 6; y < FIELD_HEIGHT; ++y) {
+      for (int x = 0; x < FIELD_WIDTH; ++x) {
+        if (rand() % 3 == 0) setCell(val, x, y);
+      }
+    }
+    init_figure(&val, round % PIECE_COUNT);
+    val.fig = val.next_fig;
+    for (int r = 0; r < round % 4; ++r) rotate(&val.fig);
+    for (int x = -3; x < FIELD_WIDTH; ++x) {
+      for (int y = -2; y < 8; ++y) {
+        val.fig.x = x;
+        val.fig.y = y;
+        if (check(&val)) {
+          Figure_t fig = val.fig;
+          while (!check_y(&val)) val.fig.y++;
+          EXPECT_EQ(drop_row(val.field, &fig), val.fig.y);
+        }
+      }
+    }
+  }
+}
+
+TEST(TetrisBitboardTest, DropRow_UnderOverhang) {
+  Game_intro val = emptyGame();
+  // Навес над столбцами 0-3, под ним пусто до пола
+  for (int x = 0; x < 4; ++x) {
+    setCell(val, x, 10);
+  }
+  init_figure(&val, 0);
+  val.fig = val.next_fig;
+  val.fig.x = 0;
+  val.fig.y = 12;  // горизонтальная I (строка 2 фигуры) под навесом
+  EXPECT_EQ(drop_row(val.field, &val.fig), 17);
+  val.fig.y = 5;  // над навесом
+  EXPECT_EQ(drop_row(val.field, &val.fig), 7);
+}
+
+TEST(TetrisBitboardTest, HardDrop_LocksInOneStep) {
+  removeHighScore();
+  TetrisGame* game = tetris_create();
+  tetris_set_clock(game, Clock_virtual, 50);
+  tetris_step(game, Start);
+  const Game_intro* val = tetris_state(game);
+  int land = drop_row(val->field, &val->fig);
+
+  tetris_step(game, Down);
+  EXPECT_EQ(val->status, Spawn);
+  EXPECT_EQ(val->fig.y, land);
+  int filled = 0;
+  for (int y = 0; y < FIELD_HEIGHT; ++y) {
+    filled += __builtin_popcount(val->field[y] & (uint16_t)~WALL_MASK);
+  }
+  EXPECT_EQ(filled, 4);
+  EXPECT_NE(val->field[FIELD_HEIGHT - 1], WALL_MASK);
+  tetris_destroy(game);
+  removeHighScore();
+}
+
+TEST(TetrisBitboardTest, UpdateCurrentState_FieldAndNext) {
+  removeHighScore();
+  userInput(Start, false);
+  GameInfo_t info = updateCurrentState();
+  Game_intro* val = core(Up);
+
+  ASSERT_NE(info.field, nullptr);
+  ASSERT_NE(info.next, nullptr);
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      EXPECT_EQ(info.next[i][j], (val->next_fig.rows[i] >> j) & 1);
+    }
+  }
+
+  int cells = 0;
+  int ghost = 0;
+  for (int i = 0; i < FIELD_HEIGHT; ++i) {
+    for (int j = 0; j < FIELD_WIDTH; ++j) {
+      EXPECT_TRUE(info.field[i][j] == 0 || info.field[i][j] == 1 ||
+                  info.field[i][j] == CELL_GHOST);
+      cells += info.field[i][j] == 1;
+      ghost += info.field[i][j] == CELL_GHOST;
+    }
+  }
+  // Видимая часть текущей фигуры и ее тень на дне, поле пустое
+  EXPECT_LE(cells, 4);
+  EXPECT_EQ(ghost, 4);
+  EXPECT_EQ(info.score, 0);
+  EXPECT_EQ(info.level, 1);
+  removeHighScore();
+}
+
+// Тесты API отдельных партий
+TEST(TetrisHandleTest, CreateAndDestroy) {
+  TetrisGame* game = tetris_create();
+  ASSERT_NE(game, nullptr);
+  EXPECT_EQ(tetris_state(game)->status, Start_init);
+  tetris_destroy(game);
+  tetris_destroy(nullptr);
+}
+
+TEST(TetrisHandleTest, StepStartsGame) {
+  removeHighScore();
+  TetrisGame* game = tetris_create();
+  tetris_step(game, Start);
+  EXPECT_EQ(tetris_state(game)->status, Move_fig);
+  EXPECT_EQ(tetris_state(game)->level, 1);
+  tetris_destroy(game);
+}
+
+TEST(TetrisHandleTest, InstancesAreIndependent) {
+  removeHighScore();
+  TetrisGame* first = tetris_create();
+  TetrisGame* second = tetris_create();
+
+  tetris_step(first, Start);
+  tetris_step(first, Pause);
+  EXPECT_EQ(tetris_state(first)->pause, 1);
+  EXPECT_EQ(tetris_state(second)->status, Start_init);
+  EXPECT_EQ(tetris_state(second)->pause, 0);
+
+  GameInfo_t info_first = tetris_query(first);
+  GameInfo_t info_second = tetris_query(second);
+  EXPECT_NE(info_first.field, info_second.field);
+  EXPECT_EQ(info_first.pause, 1);
+  EXPECT_EQ(info_second.pause, 0);
+
+  tetris_destroy(first);
+  tetris_destroy(second);
+}
+
+TEST(TetrisHandleTest, QueryMatchesState) {
+  removeHighScore();
+  TetrisGame* game = tetris_create();
+  tetris_step(game, Start);
+  const Game_intro* val = tetris_state(game);
+  GameInfo_t info = tetris_query(game);
+  int ghost_y = drop_row(val->field, &val->fig);
+  ASSERT_GT(ghost_y, val->fig.y + 4);
+
+  for (int i = 0; i < FIELD_HEIGHT; ++i) {
+    int fig_i = i - val->fig.y;
+    int ghost_i = i - ghost_y;
+    for (int j = 0; j < FIELD_WIDTH; ++j) {
+      int fig_j = j - val->fig.x;
+      int expected = 0;
+      if (fig_i >= 0 && fig_i < 4 && fig_j >= 0 && fig_j < 4) {
+        expected = (val->fig.rows[fig_i] >> fig_j) & 1;
+      }
+      if (ghost_i >= 0 && ghost_i < 4 && fig_j >= 0 && fig_j < 4 &&
+          ((val->fig.rows[ghost_i] >> fig_j) & 1)) {
+        expected = CELL_GHOST;
+      }
+      EXPECT_EQ(info.field[i][j], expected);
+    }
+  }
+  tetris_destroy(game);
+}
+
+// Тесты часов партии
+TEST(TetrisClockTest, VirtualClockAdvancesPerStep) {
+  TetrisClock_t clock{};
+  clock.kind = Clock_virtual;
+  clock.tick_ms = 50;
+  EXPECT_EQ(clock_now(&clock), 0);
+  clock_tick(&clock);
+  clock_tick(&clock);
+  EXPECT_EQ(clock_now(&clock), 100);
+}
+
+TEST(TetrisClockTest, MonotonicClockIgnoresTicks) {
+  TetrisClock_t clock{};
+  long long before = clock_now(&clock);
+  clock_tick(&clock);
+  EXPECT_EQ(clock.virtual_ms, 0);
+  EXPECT_GE(clock_now(&clock), before);
+}
+
+TEST(TetrisClockTest, GravityFollowsVirtualTime) {
+  removeHighScore();
+  TetrisGame* game = tetris_create();
+  tetris_set_clock(game, Clock_virtual, 50);
+  tetris_step(game, Start);
+  int start_y = tetris_state(game)->fig.y;
+
+  // Задержка на первом уровне 380 мс: восемь шагов по 50 мс
+  for (int i = 0; i < 7; ++i) {
+    tetris_step(game, Up);
+  }
+  EXPECT_EQ(tetris_state(game)->fig.y, start_y);
+  tetris_step(game, Up);
+  EXPECT_EQ(tetris_state(game)->fig.y, start_y + 1);
+  tetris_destroy(game);
+}
+
+TEST(TetrisClockTest, ClockSurvivesRestart) {
+  TetrisGame* game = tetris_create();
+  tetris_set_clock(game, Clock_virtual, 10);
+  tetris_step(game, Start);
+  EXPECT_EQ(tetris_state(game)->clock.kind, Clock_virtual);
+  EXPECT_EQ(tetris_state(game)->clock.tick_ms, 10);
+  EXPECT_EQ(tetris_state(game)->clock.virtual_ms, 10);
+  tetris_destroy(game);
+  removeHighScore();
+}
+
+// Тесты перечисления установок
+namespace {
+
+Game_intro withFigure(int num) {
+  Game_intro val = emptyGame();
+  init_figure(&val, num);
+  val.fig = val.next_fig;
+  return val;
+}
+
+}  // namespace
+
+TEST(TetrisPlacementTest, SquareOnEmptyField) {
+  Game_intro val = withFigure(3);
+  Placement_t out[MAX_PLACEMENTS];
+  int count = find_placements(&val, out, MAX_PLACEMENTS);
+
+  // Квадрат занимает столбцы x+1..x+2: 9 позиций, повороты совпадают
+  EXPECT_EQ(count, 9);
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(out[i].y, 17);
+    EXPECT_EQ(out[i].game_over, 0);
+    EXPECT_EQ(out[i].lines, 0);
+    EXPECT_EQ(out[i].field[18], out[i].field[19]);
+    EXPECT_NE(out[i].field[19], WALL_MASK);
+  }
+}
+
+TEST(TetrisPlacementTest, DistinctFootprints) {
+  Placement_t out[MAX_PLACEMENTS];
+  // I: 7 горизонтальных + 10 вертикальных, T: 8 + 9 + 8 + 9
+  Game_intro val = withFigure(0);
+  EXPECT_EQ(find_placements(&val, out, MAX_PLACEMENTS), 17);
+  val = withFigure(4);
+  EXPECT_EQ(find_placements(&val, out, MAX_PLACEMENTS), 34);
+}
+
+TEST(TetrisPlacementTest, ResultMatchesEndval) {
+  Game_intro val = withFigure(0);
+  for (int x = 0; x < FIELD_WIDTH - 4; ++x) {
+    setCell(val, x, 19);
+  }
+  Placement_t out[MAX_PLACEMENTS];
+  int count = find_placements(&val, out, MAX_PLACEMENTS);
+
+  int clears = 0;
+  for (int i = 0; i < count; ++i) {
+    Game_intro check_val = val;
+    check_val.fig = out[i].fig;
+    int score = endval(&check_val);
+    EXPECT_EQ(out[i].score, score);
+    for (int y = 0; y < FIELD_HEIGHT; ++y) {
+      EXPECT_EQ(out[i].field[y], check_val.field[y]);
+    }
+    EXPECT_EQ(check_figure(val.field, &out[i].fig), 1);
+    Figure_t below = out[i].fig;
+    below.y++;
+    EXPECT_EQ(check_figure(val.field, &below), 0);
+    clears += out[i].lines;
+  }
+  // Горизонтальная I справа закрывает нижнюю строку
+  EXPECT_EQ(clears, 1);
+}
+
+TEST(TetrisPlacementTest, TucksUnderOverhang) {
+  Game_intro val = withFigure(3);
+  // Крыша над левой частью поля с единственным входом справа
+  for (int x = 0; x < FIELD_WIDTH - 2; ++x) {
+    setCell(val, x, 10);
+  }
+  Placement_t out[MAX_PLACEMENTS];
+  int count = find_placements(&val, out, MAX_PLACEMENTS);
+
+  int on_roof = 0;
+  int tucked = 0;
+  for (int i = 0; i < count; ++i) {
+    on_roof += out[i].y == 7;
+    // Под крышей оказываются только фигуры, прошедшие через проем справа
+    tucked += out[i].y == 17 && out[i].fig.x + 1 < FIELD_WIDTH - 2;
+  }
+  EXPECT_EQ(on_roof, 8);
+  EXPECT_EQ(tucked, 8);
+  EXPECT_EQ(count, 8 + 9);  // на крыше и на полу (под крышей и в проеме)
+}
+
+namespace {
+
+int leftmostColumn(const Figure_t& fig) {
+  int column = FIELD_WIDTH;
+  for (int i = 0; i < 4; ++i) {
+    for (int x = 0; x < FIELD_WIDTH; ++x) {
+      if ((fig_row_mask(&fig, i) >> (x + ROW_SHIFT)) & 1u) {
+        column = std::min(column, x);
+      }
+    }
+  }
+  return column;
+}
+
+}  // namespace
+
+TEST(TetrisPlacementTest, PieceRestingAfterMoveLocks) {
+  // Щель высотой в квадрат над полкой в столбцах 0-5: квадрат въезжает
+  // в нее сдвигом, ложится на край полки и сразу фиксируется
+  Game_intro val = withFigure(3);
+  for (int x = 0; x < 6; ++x) {
+    setCell(val, x, 9);
+    setCell(val, x, 12);
+  }
+  Placement_t out[MAX_PLACEMENTS];
+  int count = find_placements(&val, out, MAX_PLACEMENTS);
+  int in_slot = 0;
+  for (int i = 0; i < count; ++i) {
+    if (out[i].y == 9 && leftmostColumn(out[i].fig) < 6) {
+      ++in_slot;
+      EXPECT_EQ(leftmostColumn(out[i].fig), 5);
+    }
+  }
+  EXPECT_EQ(in_slot, 1);
+
+  // Под полку в столбцах 0-7 L проходит только стоя. Положить ее можно в
+  // воздухе (поворот 2), а после приземления остается один поворот (3);
+  // повороты 0 и 1 потребовали бы второго действия уже лежащей фигуры.
+  val = withFigure(2);
+  for (int x = 0; x < 8; ++x) {
+    setCell(val, x, 14);
+    setCell(val, x, 16);
+  }
+  count = find_placements(&val, out, MAX_PLACEMENTS);
+  int lying = 0;
+  int turned = 0;
+  for (int i = 0; i < count; ++i) {
+    if (out[i].y >= 16 && leftmostColumn(out[i].fig) < 6) {
+      lying += out[i].rotation == 2;
+      turned += out[i].rotation == 3;
+      EXPECT_GE(out[i].rotation, 2);
+    }
+  }
+  EXPECT_GT(lying, 0);
+  EXPECT_GT(turned, 0);
+}
+
+TEST(TetrisPlacementTest, RespectsMax) {
+  Game_intro val = withFigure(4);
+  Placement_t out[5];
+  EXPECT_EQ(find_placements(&val, out, 5), 5);
+}
+
+// Тесты пула потоков и автоигрока
+namespace {
+
+void countVisit(void* arg, int index, int worker) {
+  auto* visits = static_cast<std::vector<std::atomic<int>>*>(arg);
+  (*visits)[index]++;
+  EXPECT_GE(worker, 0);
+}
+
+}  // namespace
+
+TEST(TetrisAutoplayTest, PoolVisitsEveryIndexOnce) {
+  ThreadPool_t* pool = pool_create(4);
+  ASSERT_NE(pool, nullptr);
+  EXPECT_EQ(pool_threads(pool), 4);
+  for (int round = 0; round < 50; ++round) {
+    std::vector<std::atomic<int>> visits(round * 7 + 1);
+    pool_parallel_for(pool, static_cast<int>(visits.size()), countVisit,
+                      &visits);
+    for (const auto& visit : visits) {
+      EXPECT_EQ(visit.load(), 1);
+    }
+  }
+  pool_destroy(pool);
+
+  std::vector<std::atomic<int>> visits(10);
+  pool_parallel_for(nullptr, 10, countVisit, &visits);
+  for (const auto& visit : visits) {
+    EXPECT_EQ(visit.load(), 1);
+  }
+}
+
+TEST(TetrisAutoplayTest, EvaluatePenalizesHoles) {
+  Game_intro flat = emptyGame();
+  Game_intro holed = emptyGame();
+  for (int x = 0; x < 4; ++x) {
+    setCell(flat, x, 19);
+    setCell(holed, x, 18);
+  }
+  EXPECT_DOUBLE_EQ(bot_evaluate(emptyGame().field, 0), 0.0);
+  EXPECT_GT(bot_evaluate(flat.field, 0), bot_evaluate(holed.field, 0));
+}
+
+TEST(TetrisAutoplayTest, PlanClearsLine) {
+  Game_intro val = withFigure(3);
+  val.next_fig = val.fig;
+  init_figure(&val, 0);
+  std::swap(val.fig, val.next_fig);  // текущая I, следующая O
+  for (int x = 4; x < FIELD_WIDTH; ++x) {
+    setCell(val, x, 19);
+  }
+
+  BotOptions_t opts = {BOT_DEFAULT_BEAM, nullptr};
+  BotPlan_t plan;
+  ASSERT_EQ(bot_plan(&val, &opts, &plan), 1);
+  EXPECT_EQ(plan.target.lines, 1);
+  EXPECT_GT(plan.nodes, 0);
+  ASSERT_GT(plan.count, 0);
+  EXPECT_EQ(plan.actions[plan.count - 1], Down);
+
+  // План исполняется нажатиями в обычном цикле игры
+  val.status = Move_fig;
+  val.clock.kind = Clock_virtual;
+  val.clock.tick_ms = 50;
+  val.delay_ms = 400;
+  for (int i = 0; i < plan.count; ++i) {
+    core_step(&val, plan.actions[i]);
+  }
+  for (int i = 0; i < 100 && val.status == Move_fig; ++i) {
+    core_step(&val, Up);
+  }
+  EXPECT_EQ(val.score, 100);
+  EXPECT_EQ(val.field[19], WALL_MASK);
+  removeHighScore();
+}
+
+TEST(TetrisAutoplayTest, PoolDoesNotChangePlan) {
+  Game_intro val = withFigure(4);
+  init_figure(&val, 6);
+  for (int x = 0; x < FIELD_WIDTH; ++x) {
+    if (x % 3 != 0) setCell(val, x, 19);
+    if (x % 4 == 1) setCell(val, x, 18);
+  }
+
+  ThreadPool_t* pool = pool_create(3);
+  BotOptions_t serial = {4, nullptr};
+  BotOptions_t parallel = {4, pool};
+  BotPlan_t a;
+  BotPlan_t b;
+  ASSERT_EQ(bot_plan(&val, &serial, &a), 1);
+  ASSERT_EQ(bot_plan(&val, &parallel, &b), 1);
+  pool_destroy(pool);
+
+  EXPECT_EQ(a.target.x, b.target.x);
+  EXPECT_EQ(a.target.rotation, b.target.rotation);
+  EXPECT_EQ(a.target.y, b.target.y);
+  EXPECT_DOUBLE_EQ(a.value, b.value);
+  EXPECT_EQ(a.nodes, b.nodes);
+}
+
+// Тесты записи партий
+TEST(TetrisReplayTest, VarintEventsRoundTrip) {
+  Replay_t replay;
+  replay_init(&replay, Replay_tetris, 1);
+  const long ticks[] = {0, 0, 15, 16, 1000, 3000000000L};
+  const UserAction_t actions[] = {Start, Left, Action, Down, Pause, Right};
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_TRUE(replay_record(&replay, ticks[i], actions[i]));
+  }
+  // Частые нажатия занимают по байту
+  EXPECT_EQ(replay.data[0], Start);
+  EXPECT_EQ(replay.data[2], (15 << REPLAY_ACTION_BITS) | Action);
+
+  ReplayCursor_t cursor;
+  replay_cursor(&cursor, &replay);
+  long tick;
+  UserAction_t action;
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_TRUE(replay_next(&cursor, &tick, &action));
+    EXPECT_EQ(tick, ticks[i]);
+    EXPECT_EQ(action, actions[i]);
+  }
+  EXPECT_FALSE(replay_next(&cursor, &tick, &action));
+  replay_free(&replay);
+}
+
+TEST(TetrisReplayTest, PlaybackMatchesRecording) {
+  removeHighScore();
+  TetrisGame* game = tetris_create();
+  tetris_set_clock(game, Clock_virtual, 50);
+  tetris_seed(game, 99);
+  Replay_t replay;
+  tetris_record(game, &replay);
+
+  tetris_step(game, Start);
+  BotOptions_t opts = {BOT_DEFAULT_BEAM, nullptr};
+  BotPlan_t plan;
+  for (int piece = 0; piece < 30 && tetris_state(game)->status != Game_over;
+       ++piece) {
+    bot_plan(tetris_state(game), &opts, &plan);
+    for (int i = 0; i < plan.count; ++i) tetris_step(game, plan.actions[i]);
+    for (int i = 0; i < 3; ++i) tetris_step(game, Up);
+  }
+  tetris_record_stop(game);
+  int score = tetris_state(game)->score;
+  tetris_destroy(game);
+  EXPECT_GT(score, 0);
+  EXPECT_EQ(replay.score, score);
+
+  ASSERT_TRUE(replay_save(&replay, "tetris_test.rpl"));
+  Replay_t loaded;
+  ASSERT_TRUE(replay_load(&loaded, "tetris_test.rpl"));
+  ReplayResult_t result;
+  EXPECT_TRUE(tetris_play_replay(&loaded, &result));
+  EXPECT_EQ(result.ticks, replay.ticks);
+  EXPECT_EQ(result.score, score);
+
+  // Другое зерно - другие фигуры и другой итог
+  loaded.seed++;
+  EXPECT_FALSE(tetris_play_replay(&loaded, &result));
+
+  replay_free(&replay);
+  replay_free(&loaded);
+  std::remove("tetris_test.rpl");
+  removeHighScore();
+}
+
+TEST(TetrisReplayTest, LoadRejectsDamagedFile) {
+  Replay_t replay;
+  EXPECT_FALSE(replay_load(&replay, "missing.rpl"));
+
+  replay_init(&replay, Replay_tetris, 3);
+  replay_record(&replay, 1, Start);
+  replay_record(&replay, 200, Left);
+  ASSERT_TRUE(replay_save(&replay, "tetris_test.rpl"));
+  replay_free(&replay);
+
+  // Обрезанный поток событий
+  FILE* file = std::fopen("tetris_test.rpl", "r+b");
+  ASSERT_NE(file, nullptr);
+  std::fseek(file, -1, SEEK_END);
+  std::fputc(0x80, file);
+  std::fclose(file);
+  EXPECT_FALSE(replay_load(&replay, "tetris_test.rpl"));
+  EXPECT_EQ(replay.data, nullptr);
+  std::remove("tetris_test.rpl");
+}
+
+// Тесты генератора фигур
+TEST(TetrisRandomTest, SeedRepeatsSequence) {
+  TetrisRng_t first;
+  TetrisRng_t second;
+  rng_seed(&first, 42);
+  rng_seed(&second, 42);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(rng_next(&first), rng_next(&second));
+  }
+  rng_seed(&second, 43);
+  int same = 0;
+  for (int i = 0; i < 100; ++i) {
+    same += rng_next(&first) == rng_next(&second);
+  }
+  EXPECT_LT(same, 3);
+}
+
+TEST(TetrisRandomTest, BoundedIsUniform) {
+  TetrisRng_t rng;
+  rng_seed(&rng, 1);
+  int counts[PIECE_COUNT] = {0};
+  const int draws = 70000;
+  for (int i = 0; i < draws; ++i) {
+    uint32_t value = rng_bounded(&rng, PIECE_COUNT);
+    ASSERT_LT(value, static_cast<uint32_t>(PIECE_COUNT));
+    counts[value]++;
+  }
+  for (int count : counts) {
+    EXPECT_NEAR(count, draws / PIECE_COUNT, 400);
+  }
+}
+
+TEST(TetrisRandomTest, BagDealsEveryPieceOnce) {
+  Game_intro val{};
+  rng_seed(&val.rng, 3);
+  val.randomizer = Random_bag;
+  for (int round = 0; round < 20; ++round) {
+    int seen = 0;
+    for (int i = 0; i < PIECE_COUNT; ++i) {
+      int piece = next_piece(&val);
+      ASSERT_GE(piece, 0);
+      ASSERT_LT(piece, PIECE_COUNT);
+      seen |= 1 << piece;
+    }
+    EXPECT_EQ(seen, (1 << PIECE_COUNT) - 1);
+  }
+}
+
+TEST(TetrisRandomTest, InstancesHaveIndependentStreams) {
+  removeHighScore();
+  auto pieces = [](TetrisGame* game, std::vector<int>& out) {
+    tetris_step(game, Start);
+    for (int i = 0; i < 50; ++i) {
+      out.push_back(tetris_state(game)->next_fig.piece);
+      tetris_step(game, Down);
+      tetris_step(game, Up);
+    }
+  };
+  TetrisGame* first = tetris_create();
+  TetrisGame* second = tetris_create();
+  tetris_seed(first, 11);
+  tetris_seed(second, 11);
+  std::vector<int> first_pieces;
+  std::vector<int> second_pieces;
+  // Чередование шагов двух партий не влияет на их фигуры
+  pieces(first, first_pieces);
+  TetrisGame* other = tetris_create();
+  tetris_seed(other, 12);
+  std::vector<int> other_pieces;
+  pieces(other, other_pieces);
+  pieces(second, second_pieces);
+  EXPECT_EQ(first_pieces, second_pieces);
+  EXPECT_NE(first_pieces, other_pieces);
+  tetris_destroy(first);
+  tetris_destroy(second);
+  tetris_destroy(other);
+  removeHighScore();
+}
+
+TEST(LatencyTest, BucketsAreExactForSmallValues) {
+  for (uint64_t ns = 0; ns < 2 * LATENCY_SUB_BUCKETS; ++ns) {
+    EXPECT_EQ(latency_bucket_limit(latency_bucket(ns)), ns);
+  }
+}
+
+TEST(LatencyTest, BucketLimitBoundsRelativeError) {
+  for (uint64_t ns = 1; ns < (1ull << 40); ns = ns * 3 + 1) {
+    uint64_t limit = latency_bucket_limit(latency_bucket(ns));
+    EXPECT_GE(limit, ns);
+    EXPECT_LE(limit - ns, ns / LATENCY_SUB_BUCKETS);
+  }
+  EXPECT_EQ(latency_bucket(UINT64_MAX), LATENCY_BUCKETS - 1);
+  EXPECT_EQ(latency_bucket_limit(LATENCY_BUCKETS - 1), UINT64_MAX);
+}
+
+TEST(LatencyTest, StatsReportPercentilesAndMax) {
+  latency_reset();
+  LatencyStats_t stats;
+  EXPECT_FALSE(latency_stats(Latency_update, &stats));
+
+  // 1000 вызовов по 1..1000 мкс и один выброс в 50 мс
+  for (uint64_t us = 1; us <= 1000; ++us) {
+    latency_record(Latency_update, us * 1000);
+  }
+  latency_record(Latency_update, 50000000);
+  ASSERT_TRUE(latency_stats(Latency_update, &stats));
+  EXPECT_EQ(stats.count, 1001u);
+  EXPECT_EQ(stats.max, 50000000u);
+  EXPECT_NEAR(static_cast<double>(stats.p50), 501000.0, 501000.0 / 16);
+  EXPECT_NEAR(static_cast<double>(stats.p99), 991000.0, 991000.0 / 16);
+
+  latency_reset();
+  EXPECT_FALSE(latency_stats(Latency_update, &stats));
+}
+
+#ifdef BRICK_LATENCY
+TEST(LatencyTest, EngineCallsAreRecorded) {
+  latency_reset();
+  userInput(Start, false);
+  updateCurrentState();
+  LatencyStats_t stats;
+  ASSERT_TRUE(latency_stats(Latency_input, &stats));
+  EXPECT_EQ(stats.count, 1u);
+  ASSERT_TRUE(latency_stats(Latency_state, &stats));
+  EXPECT_EQ(stats.count, 1u);
+  // Каждый вызов шагает движок
+  ASSERT_TRUE(latency_stats(Latency_update, &stats));
+  EXPECT_EQ(stats.count, 2u);
+  latency_reset();
+}
+#endif
+
+namespace {
+
+LeaderboardEntry_t makeEntry(int score, uint64_t seed) {
+  LeaderboardEntry_t entry{};
+  entry.score = score;
+  entry.level = score / 600;
+  entry.timestamp = 1700000000 + score;
+  entry.seed = seed;
+  return entry;
+}
+
+int submitEntry(Leaderboard_t* board, int game, int score, uint64_t seed) {
+  LeaderboardEntry_t entry = makeEntry(score, seed);
+  return leaderboard_submit(board, game, &entry);
+}
+
+void removeBoard(const char* path) {
+  std::remove(path);
+  std::remove((std::string(path) + ".lock").c_str());
+}
+
+}  // namespace
+
+TEST(LeaderboardTest, KeepsTopEntriesInOrder) {
+  const char* path = "leaderboard_test.dat";
+  removeBoard(path);
+  Leaderboard_t board;
+  ASSERT_TRUE(leaderboard_open(&board, path));
+  int count = -1;
+  EXPECT_EQ(leaderboard_entries(&board, Replay_tetris, &count), nullptr);
+  EXPECT_EQ(count, 0);
+
+  EXPECT_EQ(submitEntry(&board, Replay_tetris, 500, 1), 1);
+  EXPECT_EQ(submitEntry(&board, Replay_tetris, 900, 2), 1);
+  // Равный счет встает после уже записанного
+  EXPECT_EQ(submitEntry(&board, Replay_tetris, 500, 3), 3);
+  for (int i = 0; i < 2 * LEADERBOARD_SIZE; ++i) {
+    submitEntry(&board, Replay_tetris, 100 * i, 10 + i);
+  }
+  // Меньше последнего места - файл не меняется
+  EXPECT_EQ(submitEntry(&board, Replay_tetris, 1, 99), 0);
+
+  const LeaderboardEntry_t* entries =
+      leaderboard_entries(&board, Replay_tetris, &count);
+  ASSERT_EQ(count, LEADERBOARD_SIZE);
+  for (int i = 1; i < count; ++i) {
+    EXPECT_GE(entries[i - 1].score, entries[i].score);
+  }
+  EXPECT_EQ(entries[0].score, 1900);
+  EXPECT_EQ(entries[0].seed, 29u);
+  EXPECT_EQ(entries[0].level, 3);
+  // Таблица змейки не тронута
+  EXPECT_EQ(leaderboard_entries(&board, Replay_snake, &count), nullptr);
+  EXPECT_EQ(submitEntry(&board, LEADERBOARD_GAMES, 1, 1), -1);
+
+  leaderboard_close(&board);
+  removeBoard(path);
+}
+
+TEST(LeaderboardTest, OtherHandleSeesUpdate) {
+  const char* path = "leaderboard_test.dat";
+  removeBoard(path);
+  Leaderboard_t writer;
+  Leaderboard_t reader;
+  ASSERT_TRUE(leaderboard_open(&writer, path));
+  ASSERT_TRUE(leaderboard_open(&reader, path));
+  EXPECT_FALSE(leaderboard_refresh(&reader));
+
+  submitEntry(&writer, Replay_snake, 40, 7);
+  ASSERT_TRUE(leaderboard_refresh(&reader));
+  int count = 0;
+  const LeaderboardEntry_t* entries =
+      leaderboard_entries(&reader, Replay_snake, &count);
+  ASSERT_EQ(count, 1);
+  EXPECT_EQ(entries[0].score, 40);
+
+  // Старое отображение остается целым после подмены файла
+  submitEntry(&writer, Replay_snake, 50, 8);
+  EXPECT_EQ(entries[0].score, 40);
+  ASSERT_TRUE(leaderboard_refresh(&reader));
+  entries = leaderboard_entries(&reader, Replay_snake, &count);
+  ASSERT_EQ(count, 2);
+  EXPECT_EQ(entries[0].score, 50);
+
+  leaderboard_close(&writer);
+  leaderboard_close(&reader);
+  removeBoard(path);
+}
+
+TEST(LeaderboardTest, LongPathKeepsSuffixes) {
+  // Самый длинный допустимый путь: "./" до LEADERBOARD_PATH_MAX - 1 знаков
+  std::string name = "lb_long.dat";
+  std::string path;
+  while (path.size() + name.size() < LEADERBOARD_PATH_MAX - 1) path += "./";
+  path += name;
+  ASSERT_EQ(path.size(), static_cast<std::size_t>(LEADERBOARD_PATH_MAX - 1));
+  removeBoard(name.c_str());
+
+  Leaderboard_t board;
+  ASSERT_TRUE(leaderboard_open(&board, path.c_str()));
+  EXPECT_EQ(submitEntry(&board, Replay_tetris, 100, 1), 1);
+  leaderboard_close(&board);
+  EXPECT_EQ(access(name.c_str(), F_OK), 0);
+  EXPECT_EQ(access((name + ".lock").c_str(), F_OK), 0);
+  EXPECT_NE(access((name + ".tmp").c_str(), F_OK), 0);
+
+  EXPECT_FALSE(leaderboard_open(&board, (path + "x").c_str()));
+  removeBoard(name.c_str());
+}
+
+TEST(LeaderboardTest, RejectsDamagedFile) {
+  const char* path = "leaderboard_test.dat";
+  removeBoard(path);
+  Leaderboard_t board;
+  ASSERT_TRUE(leaderboard_open(&board, path));
+  submitEntry(&board, Replay_tetris, 300, 1);
+  leaderboard_close(&board);
+
+  // Портим счет первой записи: контрольная сумма не сходится
+  FILE* file = std::fopen(path, "r+b");
+  ASSERT_NE(file, nullptr);
+  std::fseek(file, offsetof(LeaderboardFile_t, tables), SEEK_SET);
+  std::fputc(0x7F, file);
+  std::fclose(file);
+
+  ASSERT_TRUE(leaderboard_open(&board, path));
+  EXPECT_FALSE(leaderboard_refresh(&board));
+  // Запись начинает таблицу заново
+  EXPECT_EQ(submitEntry(&board, Replay_tetris, 10, 2), 1);
+  EXPECT_TRUE(leaderboard_refresh(&board));
+  leaderboard_close(&board);
+  removeBoard(path);
+}
+
+TEST(LeaderboardTest, ProcessesDoNotLoseUpdates) {
+  const char* path = "leaderboard_test.dat";
+  removeBoard(path);
+  const int processes = 4;
+  const int per_process = 6;
+  std::vector<pid_t> children;
+  for (int p = 0; p < processes; ++p) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      Leaderboard_t board;
+      int ok = leaderboard_open(&board, path);
+      for (int i = 0; i < per_process && ok; ++i) {
+        // Счета всех процессов различны: 1..processes * per_process
+        ok = submitEntry(&board, Replay_snake, i * processes + p + 1, p) >= 0;
+      }
+      leaderboard_close(&board);
+      _exit(ok ? 0 : 1);
+    }
+    ASSERT_GT(pid, 0);
+    children.push_back(pid);
+  }
+  for (pid_t pid : children) {
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  }
+
+  Leaderboard_t board;
+  ASSERT_TRUE(leaderboard_open(&board, path));
+  ASSERT_TRUE(leaderboard_refresh(&board));
+  int count = 0;
+  const LeaderboardEntry_t* entries =
+      leaderboard_entries(&board, Replay_snake, &count);
+  ASSERT_EQ(count, LEADERBOARD_SIZE);
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(entries[i].score, processes * per_process - i);
+  }
+  leaderboard_close(&board);
+  removeBoard(path);
+}
+
+namespace {
+
+// Партия бота, доведенная до конца сбросами
+void playToGameOver(TetrisGame* game) {
+  tetris_set_clock(game, Clock_virtual, 50);
+  tetris_seed(game, 99);
+  tetris_step(game, Start);
+  BotOptions_t opts = {BOT_DEFAULT_BEAM, nullptr};
+  BotPlan_t plan;
+  for (int piece = 0; piece < 30; ++piece) {
+    bot_plan(tetris_state(game), &opts, &plan);
+    for (int i = 0; i < plan.count; ++i) tetris_step(game, plan.actions[i]);
+    for (int i = 0; i < 3; ++i) tetris_step(game, Up);
+  }
+  for (int i = 0; i < 500 && tetris_state(game)->status != Game_over; ++i) {
+    tetris_step(game, Down);
+  }
+}
+
+}  // namespace
+
+TEST(LeaderboardTest, OnlyPersistentGamesSaveResults) {
+  removeHighScore();
+  removeBoard(LEADERBOARD_FILE);
+
+  // Боты, копии для просмотра вперед и проверка записей ничего не пишут
+  TetrisGame* bot = tetris_create();
+  TetrisGame* fork = tetris_fork(bot);
+  playToGameOver(bot);
+  playToGameOver(fork);
+  ASSERT_EQ(tetris_state(bot)->status, Game_over);
+  EXPECT_GT(tetris_state(bot)->high_score, 0);
+  highscore_flush();
+  EXPECT_NE(access("highscore.dat", F_OK), 0);
+  EXPECT_NE(access(LEADERBOARD_FILE, F_OK), 0);
+
+  TetrisGame* player = tetris_create();
+  tetris_set_persist(player, 1);
+  TetrisGame* lookahead = tetris_fork(player);
+  playToGameOver(lookahead);
+  highscore_flush();
+  EXPECT_NE(access(LEADERBOARD_FILE, F_OK), 0);
+  playToGameOver(player);
+  highscore_flush();
+  EXPECT_EQ(access("highscore.dat", F_OK), 0);
+  Leaderboard_t board;
+  ASSERT_TRUE(leaderboard_open(&board, LEADERBOARD_FILE));
+  int count = 0;
+  const LeaderboardEntry_t* entries =
+      leaderboard_entries(&board, Replay_tetris, &count);
+  ASSERT_EQ(count, 1);
+  EXPECT_EQ(entries[0].score, tetris_state(player)->score);
+  leaderboard_close(&board);
+
+  tetris_destroy(bot);
+  tetris_destroy(fork);
+  tetris_destroy(player);
+  tetris_destroy(lookahead);
+  removeHighScore();
+  removeBoard(LEADERBOARD_FILE);
+}
+
+namespace {
+
+// Шаги партии по фиксированному сценарию, начиная с шага from
+void playScript(TetrisGame* game, int from, int steps) {
+  static const UserAction_t SCRIPT[] = {Left, Up, Action, Up, Right,
+                                        Up,   Up, Down,   Up, Up};
+  for (int i = from; i < from + steps; ++i) {
+    UserAction_t action = SCRIPT[i % 10];
+    if (tetris_state(game)->status == Game_over) action = Start;
+    tetris_step(game, action);
+  }
+}
+
+TetrisGame* scriptedGame(int steps) {
+  TetrisGame* game = tetris_create();
+  tetris_set_clock(game, Clock_virtual, 50);
+  tetris_set_randomizer(game, Random_bag);
+  tetris_seed(game, 2024);
+  tetris_step(game, Start);
+  playScript(game, 0, steps);
+  return game;
+}
+
+}  // namespace
+
+TEST(TetrisSnapshotTest, RoundTripPreservesState) {
+  TetrisGame* game = scriptedGame(333);
+  const Game_intro* val = tetris_state(game);
+  TetrisSnapshot_t snap;
+  tetris_snapshot(game, &snap);
+  EXPECT_EQ(sizeof(snap), 96u);
+
+  Game_intro copy{};
+  ASSERT_TRUE(tetris_unpack(&snap, &copy));
+  for (int y = 0; y < FIELD_HEIGHT; ++y) {
+    EXPECT_EQ(copy.field[y], val->field[y]) << "row " << y;
+  }
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(copy.fig.rows[i], val->fig.rows[i]);
+    EXPECT_EQ(copy.next_fig.rows[i], val->next_fig.rows[i]);
+  }
+  EXPECT_EQ(copy.fig.x, val->fig.x);
+  EXPECT_EQ(copy.fig.y, val->fig.y);
+  EXPECT_EQ(copy.score, val->score);
+  EXPECT_EQ(copy.level, val->level);
+  EXPECT_EQ(copy.status, val->status);
+  EXPECT_EQ(copy.rng.state, val->rng.state);
+  EXPECT_EQ(copy.clock.virtual_ms, val->clock.virtual_ms);
+  EXPECT_EQ(copy.bag_left, val->bag_left);
+  EXPECT_EQ(copy.randomizer, Random_bag);
+
+  TetrisSnapshot_t again;
+  tetris_pack(&copy, &again);
+  EXPECT_EQ(std::memcmp(&snap, &again, sizeof(snap)), 0);
+  tetris_destroy(game);
+}
+
+TEST(TetrisSnapshotTest, RestoreContinuesIdentically) {
+  TetrisGame* game = scriptedGame(200);
+  TetrisSnapshot_t snap;
+  tetris_snapshot(game, &snap);
+  playScript(game, 200, 500);
+
+  // Снимок переносится в другую партию обычным копированием байт
+  TetrisSnapshot_t copy;
+  std::memcpy(&copy, &snap, sizeof(snap));
+  TetrisGame* other = tetris_create();
+  ASSERT_TRUE(tetris_restore(other, &copy));
+  playScript(other, 200, 500);
+
+  GameInfo_t first = tetris_query(game);
+  GameInfo_t second = tetris_query(other);
+  EXPECT_EQ(first.score, second.score);
+  EXPECT_EQ(replay_board_hash(&first), replay_board_hash(&second));
+  tetris_destroy(game);
+  tetris_destroy(other);
+}
+
+TEST(TetrisSnapshotTest, ForkIsIndependent) {
+  TetrisGame* game = scriptedGame(150);
+  TetrisSnapshot_t before;
+  tetris_snapshot(game, &before);
+
+  TetrisGame* fork = tetris_fork(game);
+  ASSERT_NE(fork, nullptr);
+  playScript(fork, 150, 400);
+  TetrisSnapshot_t after;
+  tetris_snapshot(game, &after);
+  EXPECT_EQ(std::memcmp(&before, &after, sizeof(before)), 0);
+  // У копии свои буферы отрисовки
+  EXPECT_NE(tetris_query(fork).field, tetris_query(game).field);
+
+  // Копия повторяет партию, которая идет тем же сценарием
+  playScript(game, 150, 400);
+  GameInfo_t first = tetris_query(game);
+  GameInfo_t second = tetris_query(fork);
+  EXPECT_EQ(first.score, second.score);
+  EXPECT_EQ(replay_board_hash(&first), replay_board_hash(&second));
+  tetris_destroy(game);
+  tetris_destroy(fork);
+}
+
+TEST(TetrisSnapshotTest, UnpackRejectsDamagedSnapshot) {
+  TetrisGame* game = scriptedGame(50);
+  TetrisSnapshot_t snap;
+  tetris_snapshot(game, &snap);
+  Game_intro val = emptyGame();
+  val.score = 77;
+
+  TetrisSnapshot_t bad = snap;
+  bad.version = SNAPSHOT_VERSION + 1;
+  EXPECT_FALSE(tetris_unpack(&bad, &val));
+  bad = snap;
+  bad.fig_piece = PIECE_COUNT;
+  EXPECT_FALSE(tetris_unpack(&bad, &val));
+  bad = snap;
+  bad.status = Game_over + 1;
+  EXPECT_FALSE(tetris_unpack(&bad, &val));
+  bad = snap;
+  bad.bag[0] = PIECE_COUNT;
+  EXPECT_FALSE(tetris_unpack(&bad, &val));
+  EXPECT_EQ(val.score, 77);
+  EXPECT_TRUE(tetris_unpack(&snap, &val));
+  tetris_destroy(game);
+}
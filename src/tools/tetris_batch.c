@@ -0,0 +1,332 @@
+#include "tetris_batch.h"
+
+#include <getopt.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+
+/**
+ * @brief Общие данные запуска, разделяемые рабочими потоками.
+ */
+typedef struct {
+  const BatchOptions_t *opts;
+  atomic_int next_game;       ///< Номер следующей партии для выдачи
+  atomic_llong total_ticks;   ///< Сумма шагов по всем партиям
+  int *scores;                ///< Итоговый счет каждой партии
+} BatchRun_t;
+
+int main(int argc, char *argv[]) {
+  BatchOptions_t opts = {.games = 1000,
+                         .threads = 4,
+                         .seed = 1,
+                         .max_ticks = 100000,
+                         .policy = Policy_random,
+                         .beam_width = BOT_DEFAULT_BEAM};
+  if (!parse_options(argc, argv, &opts)) {
+    fprintf(stderr,
+            "Usage: %s [-n games] [-t threads] [-s seed] [-m max_ticks] "
+            "[-p random|sweep|bot] [-w beam_width] [-b] [-B] "
+            "[-r record_file] [-v replay_file]\n",
+            argv[0]);
+    return 1;
+  }
+  if (opts.search_bench) {
+    run_search_bench(&opts);
+    return 0;
+  }
+  if (opts.verify_path) {
+    return verify_replay(&opts);
+  }
+  if (opts.record_path) {
+    return record_replay(&opts);
+  }
+
+  int *scores = calloc(opts.games, sizeof(int));
+  pthread_t *threads = calloc(opts.threads, sizeof(pthread_t));
+  if (!scores || !threads) {
+    fprintf(stderr, "Out of memory\n");
+    free(scores);
+    free(threads);
+    return 1;
+  }
+
+  BatchRun_t run = {.opts = &opts, .scores = scores};
+  atomic_init(&run.next_game, 0);
+  atomic_init(&run.total_ticks, 0);
+
+  // Партии раздаются через счетчик, поэтому если запустилась только часть
+  // потоков, они сыграют все партии; join - только запущенных
+  double started = monotonic_seconds();
+  int running = 0;
+  while (running < opts.threads &&
+         pthread_create(&threads[running], NULL, worker, &run) == 0) {
+    running++;
+  }
+  for (int i = 0; i < running; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  double elapsed = monotonic_seconds() - started;
+
+  if (running == 0) {
+    fprintf(stderr, "Failed to start worker threads\n");
+  } else {
+    if (running < opts.threads) {
+      fprintf(stderr, "Started %d of %d threads\n", running, opts.threads);
+      opts.threads = running;
+    }
+    print_report(&opts, scores, atomic_load(&run.total_ticks), elapsed);
+  }
+
+  free(scores);
+  free(threads);
+  return running > 0 ? 0 : 1;
+}
+
+int parse_options(int argc, char *argv[], BatchOptions_t *opts) {
+  int ok = 1;
+  int opt;
+  while (ok && (opt = getopt(argc, argv, "n:t:s:m:p:w:Bbr:v:")) != -1) {
+    if (opt == 'n') {
+      opts->games = atoi(optarg);
+    } else if (opt == 't') {
+      opts->threads = atoi(optarg);
+    } else if (opt == 's') {
+      opts->seed = strtoull(optarg, NULL, 10);
+    } else if (opt == 'm') {
+      opts->max_ticks = atol(optarg);
+    } else if (opt == 'p' && strcmp(optarg, "random") == 0) {
+      opts->policy = Policy_random;
+    } else if (opt == 'p' && strcmp(optarg, "sweep") == 0) {
+      opts->policy = Policy_sweep;
+    } else if (opt == 'p' && strcmp(optarg, "bot") == 0) {
+      opts->policy = Policy_bot;
+    } else if (opt == 'w') {
+      opts->beam_width = atoi(optarg);
+    } else if (opt == 'B') {
+      opts->search_bench = 1;
+    } else if (opt == 'b') {
+      opts->bag = 1;
+    } else if (opt == 'r') {
+      opts->record_path = optarg;
+    } else if (opt == 'v') {
+      opts->verify_path = optarg;
+    } else {
+      ok = 0;
+    }
+  }
+  return ok && opts->games > 0 && opts->threads > 0 && opts->max_ticks > 0 &&
+         opts->beam_width > 0;
+}
+
+double monotonic_seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+uint64_t policy_next(PolicyState_t *policy) {
+  // splitmix64: достаточно для выбора действий, состояние на каждую партию
+  uint64_t z = (policy->rng += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+UserAction_t policy_random(PolicyState_t *policy) {
+  static const UserAction_t ACTIONS[] = {Left, Right, Action, Down, Up};
+  return ACTIONS[policy_next(policy) % 5];
+}
+
+UserAction_t policy_sweep(PolicyState_t *policy, const Game_intro *val) {
+  // Новая фигура появляется выше предыдущей позиции
+  if (val->fig.y < policy->last_y) {
+    policy->piece++;
+    policy->rotations = 0;
+  }
+  policy->last_y = val->fig.y;
+
+  int target_rotations = policy->piece % 4;
+  int target_x = (policy->piece * 3) % FIELD_WIDTH - 1;
+  UserAction_t action = Down;
+  if (policy->rotations < target_rotations) {
+    policy->rotations++;
+    action = Action;
+  } else if (val->fig.x < target_x && check_right(val)) {
+    action = Right;
+  } else if (val->fig.x > target_x && check_left(val)) {
+    action = Left;
+  }
+  return action;
+}
+
+UserAction_t policy_bot(PolicyState_t *policy, const Game_intro *val) {
+  if (val->fig.y < policy->last_y) {
+    double started = monotonic_seconds();
+    bot_plan(val, &policy->bot, &policy->plan);
+    policy->search_time += monotonic_seconds() - started;
+    policy->nodes += policy->plan.nodes;
+    policy->step = 0;
+  }
+  policy->last_y = val->fig.y;
+
+  // Down сразу фиксирует фигуру, остальные шаги - ожидание
+  UserAction_t action = Up;
+  if (policy->step < policy->plan.count) {
+    action = policy->plan.actions[policy->step++];
+  }
+  return action;
+}
+
+long run_game(const BatchOptions_t *opts, PolicyState_t *policy, int *score) {
+  TetrisGame *game = tetris_create();
+  long ticks = 0;
+  *score = 0;
+  if (game) {
+    tetris_set_clock(game, Clock_virtual, BATCH_TICK_MS);
+    tetris_set_randomizer(game, opts->bag ? Random_bag : Random_uniform);
+    // Фигуры партии зависят только от ее зерна, а не от соседних потоков
+    tetris_seed(game, policy->rng);
+    if (policy->replay) {
+      tetris_record(game, policy->replay);
+    }
+    tetris_step(game, Start);
+    const Game_intro *val = tetris_state(game);
+    while (val->status != Game_over && ticks < opts->max_ticks) {
+      UserAction_t action;
+      if (opts->policy == Policy_sweep) {
+        action = policy_sweep(policy, val);
+      } else if (opts->policy == Policy_bot) {
+        action = policy_bot(policy, val);
+      } else {
+        action = policy_random(policy);
+      }
+      tetris_step(game, action);
+      ticks++;
+    }
+    *score = val->score;
+    tetris_record_stop(game);
+    tetris_destroy(game);
+  }
+  return ticks;
+}
+
+long play_game(const BatchOptions_t *opts, int index, int *score) {
+  // Партии и так идут параллельно, поэтому поиск внутри партии однопоточный
+  PolicyState_t policy = {.rng = opts->seed + (uint64_t)index,
+                          .last_y = FIELD_HEIGHT,
+                          .bot = {.beam_width = opts->beam_width}};
+  return run_game(opts, &policy, score);
+}
+
+void run_search_bench(const BatchOptions_t *opts) {
+  printf("search: beam %d, seed %llu, max %ld ticks\n", opts->beam_width,
+         (unsigned long long)opts->seed, opts->max_ticks);
+  BatchOptions_t bot_opts = *opts;
+  bot_opts.policy = Policy_bot;
+  double base = 0;
+  for (int threads = 1; threads <= opts->threads; threads *= 2) {
+    ThreadPool_t *pool = pool_create(threads);
+    // Одно и то же зерно дает одну и ту же партию при любом числе потоков
+    PolicyState_t policy = {.rng = opts->seed,
+                            .last_y = FIELD_HEIGHT,
+                            .bot = {.beam_width = opts->beam_width,
+                                    .pool = pool}};
+    int score;
+    run_game(&bot_opts, &policy, &score);
+    // Пул мог запустить меньше потоков, чем просили
+    int started = pool_threads(pool);
+    pool_destroy(pool);
+
+    // Очень короткая партия может уложиться в разрешение часов
+    double rate =
+        policy.search_time > 0 ? policy.nodes / policy.search_time : 0;
+    base = threads == 1 ? rate : base;
+    printf("threads %2d: %12.0f nodes/sec  x%.2f  (%ld nodes, score %d)\n",
+           started, rate, base > 0 ? rate / base : 0, policy.nodes, score);
+  }
+}
+
+int record_replay(const BatchOptions_t *opts) {
+  Replay_t replay;
+  PolicyState_t policy = {.rng = opts->seed,
+                          .last_y = FIELD_HEIGHT,
+                          .bot = {.beam_width = opts->beam_width},
+                          .replay = &replay};
+  int score;
+  run_game(opts, &policy, &score);
+  int ok = replay_save(&replay, opts->record_path);
+  printf("recorded:   %ld ticks, %ld events, %zu bytes, score %d -> %s\n",
+         replay.ticks, replay.events, replay.size, score, opts->record_path);
+  replay_free(&replay);
+  if (!ok) {
+    fprintf(stderr, "Cannot write %s\n", opts->record_path);
+  }
+  return !ok;
+}
+
+int verify_replay(const BatchOptions_t *opts) {
+  Replay_t replay;
+  int ok = replay_load(&replay, opts->verify_path);
+  if (!ok) {
+    fprintf(stderr, "Cannot read replay %s\n", opts->verify_path);
+  } else {
+    ReplayResult_t result;
+    double started = monotonic_seconds();
+    ok = tetris_play_replay(&replay, &result);
+    double elapsed = monotonic_seconds() - started;
+    printf("replay:     %s, %ld ticks, score %d (recorded %d)\n",
+           ok ? "ok" : "MISMATCH", result.ticks, result.score, replay.score);
+    printf("ticks/sec:  %.1f\n", result.ticks / elapsed);
+    replay_free(&replay);
+  }
+  return !ok;
+}
+
+void *worker(void *arg) {
+  BatchRun_t *run = arg;
+  long long ticks = 0;
+  int index;
+  while ((index = atomic_fetch_add(&run->next_game, 1)) < run->opts->games) {
+    ticks += play_game(run->opts, index, &run->scores[index]);
+  }
+  atomic_fetch_add(&run->total_ticks, ticks);
+  return NULL;
+}
+
+static int compare_int(const void *a, const void *b) {
+  int lhs = *(const int *)a;
+  int rhs = *(const int *)b;
+  return (lhs > rhs) - (lhs < rhs);
+}
+
+void print_report(const BatchOptions_t *opts, int *scores, long long ticks,
+                  double elapsed) {
+  qsort(scores, opts->games, sizeof(int), compare_int);
+  long long sum = 0;
+  for (int i = 0; i < opts->games; i++) {
+    sum += scores[i];
+  }
+
+  static const char *POLICIES[] = {"random", "sweep", "bot"};
+  printf("games:      %d on %d threads, seed %llu, policy %s\n", opts->games,
+         opts->threads, (unsigned long long)opts->seed,
+         POLICIES[opts->policy]);
+  printf("elapsed:    %.3f s\n", elapsed);
+  printf("games/sec:  %.1f\n", opts->games / elapsed);
+  printf("ticks/sec:  %.1f (%lld ticks)\n", ticks / elapsed, ticks);
+  printf("score:      min %d  p50 %d  p90 %d  p99 %d  max %d  mean %.1f\n",
+         scores[0], scores[opts->games / 2], scores[opts->games * 9 / 10],
+         scores[opts->games * 99 / 100], scores[opts->games - 1],
+         (double)sum / opts->games);
+
+  // Гистограмма из 10 равных интервалов от 0 до максимума
+  int max = scores[opts->games - 1];
+  int width = max / 10 + 1;
+  int buckets[10] = {0};
+  for (int i = 0; i < opts->games; i++) {
+    buckets[scores[i] / width]++;
+  }
+  for (int i = 0; i < 10; i++) {
+    printf("  [%6d, %6d)  %d\n", i * width, (i + 1) * width, buckets[i]);
+  }
+}
@@ -0,0 +1,139 @@
+#ifndef TETRIS_BATCH_H
+#define TETRIS_BATCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../brick_game/tetris/tetris_autoplay.h"
+#include "../brick_game/tetris/tetris_lib.h"
+
+/// Шаг виртуальных часов партии: столько же, сколько кадр CLI
+#define BATCH_TICK_MS 50
+
+/**
+ * @brief Стратегия, которой управляются партии.
+ */
+typedef enum {
+  Policy_random,  ///< Случайные нажатия Left/Right/Action/Down/Up
+  Policy_sweep,   ///< Детерминированный сценарий: поворот, сдвиг, сброс
+  Policy_bot      ///< Лучевой поиск с учетом следующей фигуры
+} Policy_t;
+
+/**
+ * @brief Параметры пакетного запуска.
+ */
+typedef struct {
+  int games;                ///< Количество партий
+  int threads;              ///< Количество рабочих потоков
+  uint64_t seed;            ///< Базовое зерно, партия i получает seed + i
+  long max_ticks;           ///< Ограничение на число шагов одной партии
+  Policy_t policy;          ///< Стратегия управления
+  int beam_width;           ///< Ширина луча для Policy_bot
+  int bag;                  ///< Фигуры из мешка (Random_bag)
+  int search_bench;         ///< Только замер скорости поиска
+  const char *record_path;  ///< Записать одну партию в файл
+  const char *verify_path;  ///< Воспроизвести запись и сверить итог
+} BatchOptions_t;
+
+/**
+ * @brief Состояние стратегии внутри одной партии.
+ */
+typedef struct {
+  uint64_t rng;        ///< Состояние генератора действий (и зерно партии)
+  int piece;           ///< Номер текущей фигуры в партии
+  int rotations;       ///< Сколько поворотов уже сделано для текущей фигуры
+  int last_y;          ///< Позиция фигуры на предыдущем шаге
+  BotOptions_t bot;    ///< Параметры поиска для Policy_bot
+  BotPlan_t plan;      ///< План для текущей фигуры
+  int step;            ///< Номер следующего действия плана
+  long nodes;          ///< Сумма оцененных позиций за партию
+  double search_time;  ///< Время, проведенное в поиске, в секундах
+  Replay_t *replay;    ///< Запись партии или NULL
+} PolicyState_t;
+
+/**
+ * @brief Разбирает аргументы командной строки.
+ * @return 1, если параметры корректны, 0 в противном случае.
+ */
+int parse_options(int argc, char *argv[], BatchOptions_t *opts);
+
+/**
+ * @brief Возвращает монотонное время в секундах.
+ */
+double monotonic_seconds();
+
+/**
+ * @brief Следующее псевдослучайное число стратегии (splitmix64).
+ */
+uint64_t policy_next(PolicyState_t *policy);
+
+/**
+ * @brief Случайная стратегия.
+ * @return Действие для следующего шага.
+ */
+UserAction_t policy_random(PolicyState_t *policy);
+
+/**
+ * @brief Сценарная стратегия: каждая фигура поворачивается и сдвигается в
+ * заранее известный столбец, затем сбрасывается вниз.
+ * @return Действие для следующего шага.
+ */
+UserAction_t policy_sweep(PolicyState_t *policy, const Game_intro *val);
+
+/**
+ * @brief Стратегия автоигрока: для каждой новой фигуры строит план
+ * bot_plan() и выдает его действия по одному за шаг.
+ * @return Действие для следующего шага.
+ */
+UserAction_t policy_bot(PolicyState_t *policy, const Game_intro *val);
+
+/**
+ * @brief Играет одну партию до конца или до ограничения по шагам.
+ * @param index Номер партии (определяет зерно стратегии).
+ * @param score Итоговый счет.
+ * @return Количество выполненных шагов.
+ */
+long play_game(const BatchOptions_t *opts, int index, int *score);
+
+/**
+ * @brief Играет партию с подготовленным состоянием стратегии.
+ * @param policy Состояние стратегии; в нем накапливаются узлы и время поиска.
+ * @param score Итоговый счет.
+ * @return Количество выполненных шагов.
+ */
+long run_game(const BatchOptions_t *opts, PolicyState_t *policy, int *score);
+
+/**
+ * @brief Замер скорости поиска: одна и та же партия автоигрока для 1, 2,
+ * 4, ... потоков пула (до threads) с печатью узлов в секунду.
+ */
+void run_search_bench(const BatchOptions_t *opts);
+
+/**
+ * @brief Играет одну партию выбранной стратегией с зерном seed и сохраняет
+ * ее запись в record_path.
+ * @return 0 при успехе, 1 при ошибке записи.
+ */
+int record_replay(const BatchOptions_t *opts);
+
+/**
+ * @brief Воспроизводит запись из verify_path с максимальной скоростью и
+ * печатает итог и скорость.
+ * @return 0, если счет и поле совпали, 1 в противном случае.
+ */
+int verify_replay(const BatchOptions_t *opts);
+
+/**
+ * @brief Рабочий поток: разбирает партии из общего счетчика.
+ */
+void *worker(void *arg);
+
+/**
+ * @brief Печатает скорость и распределение счета.
+ */
+void print_report(const BatchOptions_t *opts, int *scores, long long ticks,
+                  double elapsed);
+
+#endif  // TETRIS_BATCH_H